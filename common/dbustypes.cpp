@@ -0,0 +1,110 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "dbustypes.h"
+
+#include <QDBusArgument>
+#include <QDBusMetaType>
+
+QDBusArgument &operator<<(QDBusArgument &argument, const PresetPreviewOutput &output)
+{
+    argument.beginStructure();
+    argument << output.name << output.x << output.y << output.width << output.height << output.priority << output.modeWidth << output.modeHeight
+             << output.refreshRate << output.scale << output.hdr << output.edr;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, PresetPreviewOutput &output)
+{
+    argument.beginStructure();
+    argument >> output.name >> output.x >> output.y >> output.width >> output.height >> output.priority >> output.modeWidth >> output.modeHeight
+        >> output.refreshRate >> output.scale >> output.hdr >> output.edr;
+    argument.endStructure();
+    return argument;
+}
+
+QDBusArgument &operator<<(QDBusArgument &argument, const PresetSummary &summary)
+{
+    argument.beginStructure();
+    argument << summary.presetId << summary.name << summary.description << summary.outputCount << summary.lastUsed << summary.shortcut
+             << summary.isAvailable << summary.isCurrent << summary.revision << summary.preview;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, PresetSummary &summary)
+{
+    argument.beginStructure();
+    argument >> summary.presetId >> summary.name >> summary.description >> summary.outputCount >> summary.lastUsed >> summary.shortcut
+        >> summary.isAvailable >> summary.isCurrent >> summary.revision >> summary.preview;
+    argument.endStructure();
+    return argument;
+}
+
+QDBusArgument &operator<<(QDBusArgument &argument, const PresetStatus &status)
+{
+    argument.beginStructure();
+    argument << status.presetId << status.isAvailable << status.isCurrent;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, PresetStatus &status)
+{
+    argument.beginStructure();
+    argument >> status.presetId >> status.isAvailable >> status.isCurrent;
+    argument.endStructure();
+    return argument;
+}
+
+QDBusArgument &operator<<(QDBusArgument &argument, const PresetsDelta &delta)
+{
+    argument.beginStructure();
+    argument << delta.added << delta.changed << delta.removed << delta.revision << delta.fullResync;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, PresetsDelta &delta)
+{
+    argument.beginStructure();
+    argument >> delta.added >> delta.changed >> delta.removed >> delta.revision >> delta.fullResync;
+    argument.endStructure();
+    return argument;
+}
+
+QDBusArgument &operator<<(QDBusArgument &argument, const PresetOutputData &output)
+{
+    argument.beginStructure();
+    argument << output.id << output.name << output.displayName << output.vendor << output.model << output.enabled << output.priority << output.x << output.y
+             << output.modeId << output.modeWidth << output.modeHeight << output.refreshRate << output.scale << output.rotation << output.overscan
+             << output.vrrPolicy << output.rgbRange << output.hdr << output.wideColorGamut << output.sdrBrightness << output.edrPolicy << output.capabilities;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, PresetOutputData &output)
+{
+    argument.beginStructure();
+    argument >> output.id >> output.name >> output.displayName >> output.vendor >> output.model >> output.enabled >> output.priority >> output.x >> output.y
+        >> output.modeId >> output.modeWidth >> output.modeHeight >> output.refreshRate >> output.scale >> output.rotation >> output.overscan
+        >> output.vrrPolicy >> output.rgbRange >> output.hdr >> output.wideColorGamut >> output.sdrBrightness >> output.edrPolicy >> output.capabilities;
+    argument.endStructure();
+    return argument;
+}
+
+void registerPresetsDBusTypes()
+{
+    qDBusRegisterMetaType<PresetPreviewOutput>();
+    qDBusRegisterMetaType<PresetPreviewOutputList>();
+    qDBusRegisterMetaType<PresetSummary>();
+    qDBusRegisterMetaType<PresetSummaryList>();
+    qDBusRegisterMetaType<PresetStatus>();
+    qDBusRegisterMetaType<PresetStatusList>();
+    qDBusRegisterMetaType<PresetsDelta>();
+    qDBusRegisterMetaType<PresetOutputData>();
+    qDBusRegisterMetaType<PresetOutputDataList>();
+}
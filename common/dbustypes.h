@@ -0,0 +1,122 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+
+class QDBusArgument;
+
+// Payloads of the org.kde.kdisplaypresets interface, shared by the daemon and
+// its clients. Only depends on QtCore and QtDBus so the applet can use it
+// without KScreen. The D-Bus signature of each type is noted above it.
+
+// (siidduiiddbb) Enabled output as a layout preview draws it, the logical
+// rectangle already has the scale and rotation applied
+struct PresetPreviewOutput {
+    QString name;
+    int x = 0;
+    int y = 0;
+    double width = 0.0;
+    double height = 0.0;
+    uint priority = 1;
+    int modeWidth = 0;
+    int modeHeight = 0;
+    double refreshRate = 0.0;
+    double scale = 1.0;
+    // Only set when the monitor supports them
+    bool hdr = false;
+    bool edr = false;
+
+    bool operator==(const PresetPreviewOutput &other) const = default;
+};
+using PresetPreviewOutputList = QList<PresetPreviewOutput>;
+
+// (sssissbbta(siidduiiddbb)) Everything about a preset except its configuration.
+// revision only changes when the configuration does, usage and metadata edits keep it.
+struct PresetSummary {
+    QString presetId;
+    QString name;
+    QString description;
+    int outputCount = 0;
+    // ISO 8601, empty if never used
+    QString lastUsed;
+    QString shortcut;
+    bool isAvailable = false;
+    bool isCurrent = false;
+    quint64 revision = 0;
+    PresetPreviewOutputList preview;
+};
+using PresetSummaryList = QList<PresetSummary>;
+
+// (sbb)
+struct PresetStatus {
+    QString presetId;
+    bool isAvailable = false;
+    bool isCurrent = false;
+};
+using PresetStatusList = QList<PresetStatus>;
+
+// (a(sssissbbta(siidduiiddbb))a(sssissbbta(siidduiiddbb))astb) Changes after a
+// revision. With fullResync set, added holds every preset and nothing else applies.
+struct PresetsDelta {
+    PresetSummaryList added;
+    PresetSummaryList changed;
+    QStringList removed;
+    quint64 revision = 0;
+    bool fullResync = false;
+};
+
+// (sssssbuiisiiddiuiibbuiu) Stored state of one output of a preset
+struct PresetOutputData {
+    QString id;
+    QString name;
+    QString displayName;
+    QString vendor;
+    QString model;
+    bool enabled = false;
+    uint priority = 1;
+    int x = 0;
+    int y = 0;
+    QString modeId;
+    int modeWidth = 0;
+    int modeHeight = 0;
+    double refreshRate = 0.0;
+    double scale = 1.0;
+    // KScreen::Output::Rotation
+    int rotation = 1;
+    uint overscan = 0;
+    int vrrPolicy = 0;
+    int rgbRange = 0;
+    bool hdr = false;
+    bool wideColorGamut = false;
+    uint sdrBrightness = 0;
+    int edrPolicy = 0;
+    uint capabilities = 0;
+};
+using PresetOutputDataList = QList<PresetOutputData>;
+
+QDBusArgument &operator<<(QDBusArgument &argument, const PresetPreviewOutput &output);
+const QDBusArgument &operator>>(const QDBusArgument &argument, PresetPreviewOutput &output);
+QDBusArgument &operator<<(QDBusArgument &argument, const PresetSummary &summary);
+const QDBusArgument &operator>>(const QDBusArgument &argument, PresetSummary &summary);
+QDBusArgument &operator<<(QDBusArgument &argument, const PresetStatus &status);
+const QDBusArgument &operator>>(const QDBusArgument &argument, PresetStatus &status);
+QDBusArgument &operator<<(QDBusArgument &argument, const PresetsDelta &delta);
+const QDBusArgument &operator>>(const QDBusArgument &argument, PresetsDelta &delta);
+QDBusArgument &operator<<(QDBusArgument &argument, const PresetOutputData &output);
+const QDBusArgument &operator>>(const QDBusArgument &argument, PresetOutputData &output);
+
+// Call before exporting or calling anything that uses these types
+void registerPresetsDBusTypes();
+
+Q_DECLARE_METATYPE(PresetPreviewOutput)
+Q_DECLARE_METATYPE(PresetSummary)
+Q_DECLARE_METATYPE(PresetStatus)
+Q_DECLARE_METATYPE(PresetsDelta)
+Q_DECLARE_METATYPE(PresetOutputData)
@@ -0,0 +1,213 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "presetconfiguration.h"
+#include "previewgeometry.h"
+
+#include <QCborMap>
+#include <QJsonArray>
+
+#include <mutex>
+#include <optional>
+
+struct PresetConfiguration::Data {
+    // Encoded form from the binary store, kept to compare and re-save without decoding
+    QByteArray cbor;
+    std::shared_ptr<const void> storage;
+
+    // The presets writer may decode on its own thread
+    std::once_flag decodeOnce;
+    QJsonObject json;
+    QList<PresetOutputSpec> outputs;
+
+    mutable std::optional<QVariantMap> variantMap;
+    mutable std::optional<PresetPreviewOutputList> preview;
+    mutable std::optional<QVariantMap> previewGeometry;
+
+    void decode()
+    {
+        if (!cbor.isNull()) {
+            json = QCborValue::fromCbor(cbor).toMap().toJsonObject();
+        }
+
+        const QJsonArray outputsArray = json[QStringLiteral("outputs")].toArray();
+        outputs.reserve(outputsArray.size());
+        for (const QJsonValue &output : outputsArray) {
+            outputs.append(PresetOutputSpec::fromJson(output.toObject()));
+        }
+    }
+};
+
+PresetOutputSpec PresetOutputSpec::fromJson(const QJsonObject &json)
+{
+    PresetOutputSpec spec;
+    spec.id = json[QStringLiteral("id")].toString();
+    spec.name = json[QStringLiteral("name")].toString();
+    spec.displayName = json[QStringLiteral("displayName")].toString();
+    spec.vendor = json[QStringLiteral("vendor")].toString();
+    spec.model = json[QStringLiteral("model")].toString();
+    spec.enabled = json[QStringLiteral("enabled")].toBool();
+    spec.priority = static_cast<uint32_t>(json[QStringLiteral("priority")].toInt(1));
+
+    const QJsonObject pos = json[QStringLiteral("pos")].toObject();
+    spec.pos = QPoint(pos[QStringLiteral("x")].toInt(), pos[QStringLiteral("y")].toInt());
+
+    const QJsonObject mode = json[QStringLiteral("mode")].toObject();
+    spec.modeSize = QSize(mode[QStringLiteral("width")].toInt(), mode[QStringLiteral("height")].toInt());
+    spec.refreshRate = static_cast<float>(mode[QStringLiteral("refreshRate")].toDouble());
+    spec.modeId = json[QStringLiteral("currentModeId")].toString(mode[QStringLiteral("id")].toString());
+
+    spec.scale = json[QStringLiteral("scale")].toDouble(1.0);
+    spec.rotation = static_cast<KScreen::Output::Rotation>(json[QStringLiteral("rotation")].toInt(KScreen::Output::None));
+
+    spec.overscan = static_cast<uint32_t>(json[QStringLiteral("overscan")].toInt());
+    spec.vrrPolicy = json[QStringLiteral("vrrPolicy")].toInt();
+    spec.rgbRange = json[QStringLiteral("rgbRange")].toInt();
+    spec.hdr = json[QStringLiteral("hdr")].toBool();
+    spec.wideColorGamut = json[QStringLiteral("wide_color_gamut")].toBool();
+    spec.sdrBrightness = static_cast<uint32_t>(json[QStringLiteral("sdr_brightness")].toInt());
+    spec.edrPolicy = json[QStringLiteral("edr_policy")].toInt();
+    spec.capabilities = static_cast<uint32_t>(json[QStringLiteral("capabilities")].toInt());
+
+    return spec;
+}
+
+PresetConfiguration::PresetConfiguration(const QJsonObject &json)
+    : d(std::make_shared<Data>())
+{
+    d->json = json;
+}
+
+PresetConfiguration PresetConfiguration::fromCbor(const QByteArray &encoded, const std::shared_ptr<const void> &storage)
+{
+    PresetConfiguration configuration;
+    configuration.d = std::make_shared<Data>();
+    configuration.d->cbor = encoded;
+    configuration.d->storage = storage;
+    return configuration;
+}
+
+const PresetConfiguration::Data &PresetConfiguration::decoded() const
+{
+    std::call_once(d->decodeOnce, [this] {
+        d->decode();
+    });
+    return *d;
+}
+
+bool PresetConfiguration::isEmpty() const
+{
+    return !d || decoded().json.isEmpty();
+}
+
+QJsonObject PresetConfiguration::toJson() const
+{
+    return d ? decoded().json : QJsonObject();
+}
+
+QCborValue PresetConfiguration::toCbor() const
+{
+    if (!d) {
+        return QCborMap();
+    }
+    if (!d->cbor.isNull()) {
+        return QCborValue::fromCbor(d->cbor);
+    }
+    return QCborMap::fromJsonObject(decoded().json);
+}
+
+QVariantMap PresetConfiguration::toVariantMap() const
+{
+    if (!d) {
+        return QVariantMap();
+    }
+
+    if (!d->variantMap) {
+        d->variantMap = decoded().json.toVariantMap();
+    }
+    return *d->variantMap;
+}
+
+// displayName (from Utils::outputName()), then vendor and model, then the connector name
+static QString previewName(const PresetOutputSpec &output)
+{
+    if (!output.displayName.isEmpty()) {
+        return output.displayName;
+    }
+
+    const QString vendorModel = QStringList{output.vendor, output.model}.join(QLatin1Char(' ')).trimmed();
+    return vendorModel.isEmpty() ? output.name : vendorModel;
+}
+
+const PresetPreviewOutputList &PresetConfiguration::previewOutputs() const
+{
+    static const PresetPreviewOutputList empty;
+    if (!d) {
+        return empty;
+    }
+
+    if (!d->preview) {
+        PresetPreviewOutputList preview;
+        for (const PresetOutputSpec &output : decoded().outputs) {
+            if (!output.enabled) {
+                continue;
+            }
+
+            const qreal scale = output.scale > 0 ? output.scale : 1.0;
+            QSizeF size = QSizeF(output.modeSize) / scale;
+            if (output.rotation == KScreen::Output::Left || output.rotation == KScreen::Output::Right) {
+                size.transpose();
+            }
+
+            PresetPreviewOutput entry;
+            entry.name = previewName(output);
+            entry.x = output.pos.x();
+            entry.y = output.pos.y();
+            entry.width = size.width();
+            entry.height = size.height();
+            entry.priority = output.priority;
+            entry.modeWidth = output.modeSize.width();
+            entry.modeHeight = output.modeSize.height();
+            entry.refreshRate = output.refreshRate;
+            entry.scale = scale;
+            entry.hdr = output.hdr && (output.capabilities & static_cast<uint32_t>(KScreen::Output::Capability::HighDynamicRange));
+            // EDR policy 1 is "always"
+            entry.edr = output.edrPolicy == 1 && (output.capabilities & static_cast<uint32_t>(KScreen::Output::Capability::Edr));
+            preview.append(entry);
+        }
+        d->preview = preview;
+    }
+    return *d->preview;
+}
+
+QVariantMap PresetConfiguration::previewGeometry() const
+{
+    if (!d) {
+        return ::previewGeometry({});
+    }
+
+    if (!d->previewGeometry) {
+        d->previewGeometry = ::previewGeometry(previewOutputs());
+    }
+    return *d->previewGeometry;
+}
+
+const QList<PresetOutputSpec> &PresetConfiguration::outputs() const
+{
+    static const QList<PresetOutputSpec> empty;
+    return d ? decoded().outputs : empty;
+}
+
+bool PresetConfiguration::operator==(const PresetConfiguration &other) const
+{
+    if (d == other.d) {
+        return true;
+    }
+    if (d && other.d && !d->cbor.isNull() && !other.d->cbor.isNull()) {
+        // Both straight from the binary store, the encoding is deterministic
+        return d->cbor == other.d->cbor;
+    }
+    return toJson() == other.toJson();
+}
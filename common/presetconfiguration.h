@@ -0,0 +1,81 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "dbustypes.h"
+
+#include <KScreen/Output>
+
+#include <QByteArray>
+#include <QCborValue>
+#include <QJsonObject>
+#include <QList>
+#include <QPoint>
+#include <QSize>
+#include <QSizeF>
+#include <QString>
+#include <QVariantMap>
+
+#include <memory>
+
+// Typed view of a single output stored in a preset, compiled once from the
+// stored configuration so status checks and apply never touch string keys.
+struct PresetOutputSpec {
+    QString id;
+    QString name;
+    QString displayName;
+    QString vendor;
+    QString model;
+    bool enabled = false;
+    uint32_t priority = 1;
+    QPoint pos;
+    QString modeId;
+    QSize modeSize;
+    float refreshRate = 0.0f;
+    qreal scale = 1.0;
+    KScreen::Output::Rotation rotation = KScreen::Output::None;
+    uint32_t overscan = 0;
+    int vrrPolicy = 0;
+    int rgbRange = 0;
+    bool hdr = false;
+    bool wideColorGamut = false;
+    uint32_t sdrBrightness = 0;
+    int edrPolicy = 0;
+    uint32_t capabilities = 0;
+
+    static PresetOutputSpec fromJson(const QJsonObject &json);
+};
+
+// Stored configuration of a preset, decoded on first use. A configuration from
+// the binary store stays CBOR-encoded until then; the typed output list is
+// compiled on decode and the QVariantMap form only when QML or D-Bus ask for it.
+class PresetConfiguration
+{
+public:
+    PresetConfiguration() = default;
+    explicit PresetConfiguration(const QJsonObject &json);
+
+    // encoded must hold one CBOR map; storage keeps the memory behind it alive
+    static PresetConfiguration fromCbor(const QByteArray &encoded, const std::shared_ptr<const void> &storage = {});
+
+    bool isEmpty() const;
+    QJsonObject toJson() const;
+    QCborValue toCbor() const;
+    QVariantMap toVariantMap() const;
+    // Enabled outputs reduced to what a layout preview draws
+    const PresetPreviewOutputList &previewOutputs() const;
+    // previewOutputs() normalized for QML, see previewgeometry.h
+    QVariantMap previewGeometry() const;
+    const QList<PresetOutputSpec> &outputs() const;
+
+    bool operator==(const PresetConfiguration &other) const;
+
+private:
+    struct Data;
+    const Data &decoded() const;
+
+    std::shared_ptr<Data> d;
+};
@@ -5,30 +5,72 @@
 */
 #include "presets.h"
 #include "kdisplaypresets_common_debug.h"
+#include "presetsstore.h"
+#include "presetswriter.h"
 
 #include <KScreen/Mode>
 
 #include <KLocalizedString>
 
-#include <QDir>
 #include <QFile>
-#include <QJsonArray>
-#include <QJsonDocument>
-#include <QJsonObject>
+#include <QFileInfo>
+#include <QSet>
 #include <QStandardPaths>
+#include <QTimer>
+
+#include <algorithm>
+#include <utility>
+
+// Editors and atomic renames produce several watcher events per change
+static constexpr int s_reloadCoalesceInterval = 100;
+// Removed preset ids remembered for incremental readers
+static constexpr int s_maxTombstones = 256;
 
 Presets::Presets(QObject *parent, const QString &customFilePath)
     : QAbstractListModel(parent)
     , m_fileWatcher(new QFileSystemWatcher(this))
+    , m_reloadTimer(new QTimer(this))
+    , m_writer(new PresetsWriter(this))
     , m_customPresetsFilePath(customFilePath)
+    , m_usageJournal(std::make_unique<UsageJournal>(usageJournalPath()))
 {
+    m_usageJournal->sync();
     loadPresetsFromDisk();
 
-    const QString filePath = presetsFilePath();
-    if (QFile::exists(filePath)) {
-        m_fileWatcher->addPath(filePath);
-    }
+    watchPresetsFile();
     connect(m_fileWatcher, &QFileSystemWatcher::fileChanged, this, &Presets::onPresetFileChanged);
+    connect(m_fileWatcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+        // Something in the directory was created, removed or renamed over
+        m_presetsFileDirty = true;
+        m_usageJournalDirty = true;
+        m_reloadTimer->start();
+    });
+
+    m_reloadTimer->setSingleShot(true);
+    m_reloadTimer->setInterval(s_reloadCoalesceInterval);
+    connect(m_reloadTimer, &QTimer::timeout, this, &Presets::reloadPresetsFile);
+
+    connect(m_writer, &PresetsWriter::written, this, [this](const QString &filePath, const QByteArray &hash, qint64 size, const QDateTime &lastModified) {
+        if (filePath != presetsStorePath()) {
+            return;
+        }
+        // Our own write must not trigger a reload once the watcher reports it
+        m_contentHash = hash;
+        m_storeSize = size;
+        m_storeModified = lastModified;
+        if (std::exchange(m_jsonMigrationPending, false)) {
+            retireMigratedJson();
+        }
+        watchPresetsFile();
+    });
+    connect(m_writer, &PresetsWriter::writeFailed, this, [this](const QString &filePath, const QString &errorString) {
+        Q_EMIT savingFailed(i18n("Could not write presets file %1: %2", filePath, errorString));
+    });
+}
+
+Presets::~Presets()
+{
+    flush();
 }
 
 int Presets::rowCount(const QModelIndex &parent) const
@@ -59,9 +101,17 @@ QVariant Presets::data(const QModelIndex &index, int role) const
     case OutputCountRole:
         return preset.outputIds.count();
     case ConfigurationRole:
-        return preset.configuration;
+        return preset.configuration.toVariantMap();
     case ShortcutRole:
         return preset.shortcut;
+    case IsAvailableRole:
+        return m_presetStatus.value(preset.id).available;
+    case IsCurrentRole:
+        return m_presetStatus.value(preset.id).current;
+    case ApplyCountRole:
+        return preset.applyCount;
+    case PreviewGeometryRole:
+        return preset.configuration.previewGeometry();
     default:
         return QVariant();
     }
@@ -78,6 +128,10 @@ QHash<int, QByteArray> Presets::roleNames() const
         {OutputCountRole, "outputCount"},
         {ConfigurationRole, "configuration"},
         {ShortcutRole, "shortcut"},
+        {IsAvailableRole, "isAvailable"},
+        {IsCurrentRole, "isCurrent"},
+        {ApplyCountRole, "applyCount"},
+        {PreviewGeometryRole, "previewGeometry"},
     };
 }
 
@@ -93,326 +147,670 @@ KScreen::ConfigPtr Presets::screenConfiguration() const
 
 void Presets::setScreenConfiguration(KScreen::ConfigPtr config)
 {
+    const bool hadScreenConfiguration = bool(m_screenConfiguration);
     m_screenConfiguration = config;
+    // The same config passed again, or one that only changed elsewhere, keeps the generation
+    if (rebuildOutputIndex() || hadScreenConfiguration != bool(m_screenConfiguration)) {
+        ++m_configGeneration;
+    }
+    updatePresetStatus();
     Q_EMIT screenConfigurationChanged();
 }
 
-bool Presets::isPresetAvailable(const QString &presetId) const
+bool Presets::rebuildOutputIndex()
 {
+    const QHash<QString, QList<OutputSnapshot>> previousIndex = std::exchange(m_outputIndex, {});
+    const int previousEnabledOutputCount = std::exchange(m_enabledOutputCount, 0);
+
     if (!m_screenConfiguration) {
-        qCDebug(KDISPLAYPRESETS_COMMON) << "No screen configuration available for preset" << presetId;
-        return false;
+        return !previousIndex.isEmpty();
     }
 
-    const auto preset = getPreset(presetId);
-    if (preset.id.isEmpty()) {
-        qCDebug(KDISPLAYPRESETS_COMMON) << "Preset not found:" << presetId;
-        return false;
+    const auto outputs = m_screenConfiguration->outputs();
+    m_outputIndex.reserve(outputs.count());
+
+    for (const auto &output : outputs) {
+        if (!output->isConnected()) {
+            continue;
+        }
+
+        // hashMd5() is computed from EDID on every call, so do it once per output here
+        const QString outputId = output->hashMd5();
+
+        OutputSnapshot snapshot;
+        snapshot.name = output->name();
+        snapshot.enabled = output->isEnabled();
+        snapshot.priority = output->priority();
+        snapshot.pos = output->pos();
+        if (const auto mode = output->currentMode()) {
+            snapshot.hasMode = true;
+            snapshot.modeSize = mode->size();
+            snapshot.refreshRate = mode->refreshRate();
+        }
+        snapshot.scale = output->scale();
+        snapshot.rotation = output->rotation();
+
+        m_outputIndex[outputId].append(snapshot);
+        if (snapshot.enabled) {
+            ++m_enabledOutputCount;
+        }
     }
 
-    // Check if all required outputs are currently connected
-    const auto presetOutputsList = preset.configuration[QStringLiteral("outputs")].toList();
-    const auto currentOutputs = m_screenConfiguration->outputs();
+    return m_enabledOutputCount != previousEnabledOutputCount || m_outputIndex != previousIndex;
+}
 
-    for (const auto &presetOutputVariant : presetOutputsList) {
-        const auto presetOutputMap = presetOutputVariant.toMap();
-        const QString presetOutputId = presetOutputMap[QStringLiteral("id")].toString();
+bool Presets::isPresetAvailable(const QString &presetId) const
+{
+    return m_presetStatus.value(presetId).available;
+}
 
-        // Only check outputs that are supposed to be enabled in the preset
-        if (!presetOutputMap[QStringLiteral("enabled")].toBool()) {
+bool Presets::isPresetCurrent(const QString &presetId) const
+{
+    return m_presetStatus.value(presetId).current;
+}
+
+void Presets::updatePresetStatus()
+{
+    // Rows added or edited since were evaluated on the way in
+    if (m_statusGeneration == m_configGeneration) {
+        return;
+    }
+    m_statusGeneration = m_configGeneration;
+
+    QStringList changedPresetIds;
+
+    for (int row = 0; row < m_presets.count(); ++row) {
+        const DisplayPreset &preset = m_presets.at(row);
+        const PresetStatus status = evaluatePresetStatus(preset);
+
+        auto it = m_presetStatus.find(preset.id);
+        if (it == m_presetStatus.end()) {
+            m_presetStatus.insert(preset.id, status);
             continue;
         }
 
-        bool found = false;
-        for (const auto &currentOutput : currentOutputs) {
-            if (currentOutput->hashMd5() == presetOutputId && currentOutput->isConnected()) {
-                found = true;
-                break;
+        if (it->available != status.available || it->current != status.current) {
+            *it = status;
+            changedPresetIds.append(preset.id);
+            Q_EMIT dataChanged(index(row), index(row), {IsAvailableRole, IsCurrentRole});
+        }
+    }
+
+    if (!changedPresetIds.isEmpty()) {
+        qCDebug(KDISPLAYPRESETS_COMMON) << "Preset status changed for" << changedPresetIds;
+        bumpRevision(changedPresetIds, false);
+        Q_EMIT presetStatusChanged(changedPresetIds);
+    }
+}
+
+Presets::PresetStatus Presets::evaluatePresetStatus(const DisplayPreset &preset) const
+{
+    PresetStatus status;
+    if (!m_screenConfiguration) {
+        qCDebug(KDISPLAYPRESETS_COMMON) << "No screen configuration available for preset" << preset.id;
+        return status;
+    }
+
+    status.available = evaluateAvailable(preset);
+    // A preset can only be current if all of its enabled outputs are connected
+    status.current = status.available && evaluateCurrent(preset);
+    return status;
+}
+
+bool Presets::evaluateAvailable(const DisplayPreset &preset) const
+{
+    // outputIds lists the enabled outputs, so the configuration stays undecoded
+    if (!preset.outputIds.isEmpty()) {
+        for (const QString &outputId : preset.outputIds) {
+            if (!m_outputIndex.contains(outputId)) {
+                qCDebug(KDISPLAYPRESETS_COMMON) << "Output not found or not connected:" << outputId << "for preset" << preset.id;
+                return false;
             }
         }
 
-        if (!found) {
-            qCDebug(KDISPLAYPRESETS_COMMON) << "Output not found or not connected:" << presetOutputId
-                                            << "(display:" << presetOutputMap[QStringLiteral("displayName")].toString()
-                                            << "was at port:" << presetOutputMap[QStringLiteral("name")].toString()
-                                            << ") for preset" << presetId;
+        qCDebug(KDISPLAYPRESETS_COMMON) << "Preset available:" << preset.id;
+        return true;
+    }
+
+    // Check if all required outputs are currently connected
+    for (const PresetOutputSpec &presetOutput : preset.configuration.outputs()) {
+        // Only check outputs that are supposed to be enabled in the preset
+        if (!presetOutput.enabled) {
+            continue;
+        }
+
+        if (!m_outputIndex.contains(presetOutput.id)) {
+            qCDebug(KDISPLAYPRESETS_COMMON) << "Output not found or not connected:" << presetOutput.id << "(display:" << presetOutput.displayName
+                                            << "was at port:" << presetOutput.name << ") for preset" << preset.id;
             return false;
         }
     }
 
-    qCDebug(KDISPLAYPRESETS_COMMON) << "Preset available:" << presetId;
+    qCDebug(KDISPLAYPRESETS_COMMON) << "Preset available:" << preset.id;
     return true;
 }
 
-bool Presets::isPresetCurrent(const QString &presetId) const
+const Presets::OutputSnapshot *Presets::matchOutput(const PresetOutputSpec &presetOutput) const
 {
-    if (!m_screenConfiguration) {
-        qCDebug(KDISPLAYPRESETS_COMMON) << "isPresetCurrent: No screen configuration available";
-        return false;
+    const auto it = m_outputIndex.constFind(presetOutput.id);
+    if (it == m_outputIndex.constEnd()) {
+        return nullptr;
     }
 
-    const auto preset = getPreset(presetId);
-    if (preset.id.isEmpty()) {
-        qCDebug(KDISPLAYPRESETS_COMMON) << "isPresetCurrent: Preset not found:" << presetId;
-        return false;
+    // Identical monitors are told apart by the connector they were saved on, then by position
+    const QList<OutputSnapshot> &candidates = it.value();
+    for (const OutputSnapshot &candidate : candidates) {
+        if (candidate.name == presetOutput.name) {
+            return &candidate;
+        }
     }
+    for (const OutputSnapshot &candidate : candidates) {
+        if (candidate.pos == presetOutput.pos) {
+            return &candidate;
+        }
+    }
+    return &candidates.first();
+}
+
+bool Presets::evaluateCurrent(const DisplayPreset &preset) const
+{
+    qCDebug(KDISPLAYPRESETS_COMMON) << "isPresetCurrent: Checking preset" << preset.id << "against current config";
+
+    int matchedEnabledOutputs = 0;
+
+    for (const PresetOutputSpec &presetOutput : preset.configuration.outputs()) {
+        const OutputSnapshot *snapshot = matchOutput(presetOutput);
 
-    qCDebug(KDISPLAYPRESETS_COMMON) << "isPresetCurrent: Checking preset" << presetId << "against current config";
+        if (!snapshot) {
+            // Preset must not expect outputs that aren't currently connected
+            if (presetOutput.enabled) {
+                qCDebug(KDISPLAYPRESETS_COMMON) << "Preset enabled output" << presetOutput.id << "(display:" << presetOutput.displayName
+                                                << "was at port:" << presetOutput.name << ") not found in current configuration";
+                return false;
+            }
+            continue;
+        }
+
+        const OutputSnapshot &currentOutput = *snapshot;
 
-    const auto presetOutputsList = preset.configuration[QStringLiteral("outputs")].toList();
-    const auto currentOutputs = m_screenConfiguration->outputs();
+        // Check if enabled state matches
+        if (currentOutput.enabled != presetOutput.enabled) {
+            qCDebug(KDISPLAYPRESETS_COMMON) << "Enabled state mismatch for" << presetOutput.id << "(port:" << currentOutput.name << ")"
+                                            << "current:" << currentOutput.enabled << "preset:" << presetOutput.enabled;
+            return false;
+        }
 
-    // Check each currently connected output
-    for (const auto &currentOutput : currentOutputs) {
-        if (!currentOutput->isConnected()) {
+        if (!currentOutput.enabled) {
             continue;
         }
 
-        bool found = false;
-        for (const auto &presetOutputVariant : presetOutputsList) {
-            const auto presetOutputMap = presetOutputVariant.toMap();
-            if (presetOutputMap[QStringLiteral("id")].toString() == currentOutput->hashMd5()) {
-                found = true;
-
-                // Check if enabled state matches
-                if (currentOutput->isEnabled() != presetOutputMap[QStringLiteral("enabled")].toBool()) {
-                    qCDebug(KDISPLAYPRESETS_COMMON) << "Enabled state mismatch for" << currentOutput->hashMd5()
-                                                    << "(port:" << currentOutput->name() << ")"
-                                                    << "current:" << currentOutput->isEnabled()
-                                                    << "preset:" << presetOutputMap[QStringLiteral("enabled")].toBool();
-                    return false;
-                }
-
-                // If output is enabled, check other properties
-                if (currentOutput->isEnabled()) {
-                    // Check priority
-                    if (static_cast<uint32_t>(presetOutputMap[QStringLiteral("priority")].toInt()) != currentOutput->priority()) {
-                        qCDebug(KDISPLAYPRESETS_COMMON) << "Priority mismatch for" << currentOutput->name()
-                                                        << "current:" << currentOutput->priority()
-                                                        << "preset:" << presetOutputMap[QStringLiteral("priority")].toInt();
-                        return false;
-                    }
-
-                    // Check position
-                    const auto presetPos = presetOutputMap[QStringLiteral("pos")].toMap();
-                    const QPoint presetPosition(presetPos[QStringLiteral("x")].toInt(), presetPos[QStringLiteral("y")].toInt());
-                    if (currentOutput->pos() != presetPosition) {
-                        qCDebug(KDISPLAYPRESETS_COMMON) << "Position mismatch for" << currentOutput->name()
-                                                        << "current:" << currentOutput->pos()
-                                                        << "preset:" << presetPosition;
-                        return false;
-                    }
-
-                    // Check mode (resolution and refresh rate)
-                    const auto presetMode = presetOutputMap[QStringLiteral("mode")].toMap();
-                    const QSize presetSize(presetMode[QStringLiteral("width")].toInt(), presetMode[QStringLiteral("height")].toInt());
-                    const float presetRefresh = presetMode[QStringLiteral("refreshRate")].toFloat();
-
-                    if (currentOutput->currentMode()) {
-                        const QSize currentSize = currentOutput->currentMode()->size();
-                        const float currentRefresh = currentOutput->currentMode()->refreshRate();
-
-                        if (currentSize != presetSize || qAbs(currentRefresh - presetRefresh) > 0.1) {
-                            qCDebug(KDISPLAYPRESETS_COMMON) << "Mode mismatch for" << currentOutput->name() << "current:" << currentSize << "@" << currentRefresh
-                                                    << "preset:" << presetSize << "@" << presetRefresh;
-                            return false;
-                        }
-                    } else {
-                        qCDebug(KDISPLAYPRESETS_COMMON) << "No current mode for" << currentOutput->name();
-                        return false;
-                    }
-
-                    // Check scale
-                    if (qAbs(currentOutput->scale() - presetOutputMap[QStringLiteral("scale")].toReal()) > 0.01) {
-                        qCDebug(KDISPLAYPRESETS_COMMON) << "Scale mismatch for" << currentOutput->name()
-                                                        << "current:" << currentOutput->scale()
-                                                        << "preset:" << presetOutputMap[QStringLiteral("scale")].toReal();
-                        return false;
-                    }
-
-                    // Check rotation
-                    if (static_cast<int>(currentOutput->rotation()) != presetOutputMap[QStringLiteral("rotation")].toInt()) {
-                        qCDebug(KDISPLAYPRESETS_COMMON) << "Rotation mismatch for" << currentOutput->name()
-                                                        << "current:" << static_cast<int>(currentOutput->rotation())
-                                                        << "preset:" << presetOutputMap[QStringLiteral("rotation")].toInt();
-                        return false;
-                    }
-                }
-                break;
-            }
+        // Check priority
+        if (presetOutput.priority != currentOutput.priority) {
+            qCDebug(KDISPLAYPRESETS_COMMON) << "Priority mismatch for" << currentOutput.name << "current:" << currentOutput.priority
+                                            << "preset:" << presetOutput.priority;
+            return false;
         }
 
-        // If current output is enabled but not found in preset, it's not current
-        if (!found && currentOutput->isEnabled()) {
-            qCDebug(KDISPLAYPRESETS_COMMON) << "Current enabled output" << currentOutput->hashMd5()
-                                            << "(port:" << currentOutput->name() << ") not found in preset";
+        // Check position
+        if (currentOutput.pos != presetOutput.pos) {
+            qCDebug(KDISPLAYPRESETS_COMMON) << "Position mismatch for" << currentOutput.name << "current:" << currentOutput.pos << "preset:" << presetOutput.pos;
             return false;
         }
-    }
 
-    // Also check that preset doesn't expect outputs that aren't currently available
-    for (const auto &presetOutputVariant : presetOutputsList) {
-        const auto presetOutputMap = presetOutputVariant.toMap();
-        if (presetOutputMap[QStringLiteral("enabled")].toBool()) {
-            const QString presetOutputId = presetOutputMap[QStringLiteral("id")].toString();
+        // Check mode (resolution and refresh rate)
+        if (!currentOutput.hasMode) {
+            qCDebug(KDISPLAYPRESETS_COMMON) << "No current mode for" << currentOutput.name;
+            return false;
+        }
 
-            bool found = false;
-            for (const auto &currentOutput : currentOutputs) {
-                if (currentOutput->hashMd5() == presetOutputId && currentOutput->isConnected() && currentOutput->isEnabled()) {
-                    found = true;
-                    break;
-                }
-            }
+        if (currentOutput.modeSize != presetOutput.modeSize || qAbs(currentOutput.refreshRate - presetOutput.refreshRate) > 0.1) {
+            qCDebug(KDISPLAYPRESETS_COMMON) << "Mode mismatch for" << currentOutput.name << "current:" << currentOutput.modeSize << "@"
+                                            << currentOutput.refreshRate << "preset:" << presetOutput.modeSize << "@" << presetOutput.refreshRate;
+            return false;
+        }
 
-            if (!found) {
-                qCDebug(KDISPLAYPRESETS_COMMON) << "Preset enabled output" << presetOutputId
-                                                << "(display:" << presetOutputMap[QStringLiteral("displayName")].toString()
-                                                << "was at port:" << presetOutputMap[QStringLiteral("name")].toString()
-                                                << ") not found in current configuration";
-                return false;
-            }
+        // Check scale
+        if (qAbs(currentOutput.scale - presetOutput.scale) > 0.01) {
+            qCDebug(KDISPLAYPRESETS_COMMON) << "Scale mismatch for" << currentOutput.name << "current:" << currentOutput.scale << "preset:" << presetOutput.scale;
+            return false;
+        }
+
+        // Check rotation
+        if (currentOutput.rotation != presetOutput.rotation) {
+            qCDebug(KDISPLAYPRESETS_COMMON) << "Rotation mismatch for" << currentOutput.name << "current:" << static_cast<int>(currentOutput.rotation)
+                                            << "preset:" << static_cast<int>(presetOutput.rotation);
+            return false;
         }
+
+        ++matchedEnabledOutputs;
+    }
+
+    // If a currently enabled output is not part of the preset, it's not current
+    if (matchedEnabledOutputs != m_enabledOutputCount) {
+        qCDebug(KDISPLAYPRESETS_COMMON) << "Current configuration has enabled outputs not found in preset" << preset.id;
+        return false;
     }
 
-    qCDebug(KDISPLAYPRESETS_COMMON) << "Preset" << presetId << "matches current configuration";
+    qCDebug(KDISPLAYPRESETS_COMMON) << "Preset" << preset.id << "matches current configuration";
     return true;
 }
 
 void Presets::refreshPresetStatus()
 {
-    Q_EMIT presetsChanged();
-    Q_EMIT dataChanged(index(0), index(rowCount() - 1));
+    // The config may have been updated in place since it was set
+    if (rebuildOutputIndex()) {
+        ++m_configGeneration;
+    }
+    updatePresetStatus();
 }
 
-DisplayPreset Presets::getPreset(const QString &presetId) const
+quint64 Presets::revision() const
 {
-    auto it = std::ranges::find_if(m_presets, [&presetId](const DisplayPreset &preset) {
-        return preset.id == presetId;
-    });
+    return m_revision;
+}
+
+quint64 Presets::presetRevision(const QString &presetId) const
+{
+    return m_revisions.value(presetId).latest;
+}
+
+quint64 Presets::presetContentRevision(const QString &presetId) const
+{
+    return m_revisions.value(presetId).content;
+}
+
+quint64 Presets::presetConfigurationRevision(const QString &presetId) const
+{
+    return m_revisions.value(presetId).configuration;
+}
+
+quint64 Presets::presetAddedRevision(const QString &presetId) const
+{
+    return m_revisions.value(presetId).added;
+}
+
+QStringList Presets::presetsChangedSince(quint64 revision) const
+{
+    QStringList presetIds;
+    for (const DisplayPreset &preset : m_presets) {
+        if (m_revisions.value(preset.id).latest > revision) {
+            presetIds.append(preset.id);
+        }
+    }
+    return presetIds;
+}
+
+QStringList Presets::presetsRemovedSince(quint64 revision) const
+{
+    QStringList presetIds;
+    for (auto it = m_tombstones.cbegin(); it != m_tombstones.cend(); ++it) {
+        if (it.value() > revision) {
+            presetIds.append(it.key());
+        }
+    }
+    return presetIds;
+}
+
+quint64 Presets::oldestTrackedRevision() const
+{
+    return m_tombstoneFloor;
+}
+
+void Presets::bumpRevision(const QStringList &presetIds, bool contentChanged, const QStringList &configurationChangedIds)
+{
+    ++m_revision;
+
+    for (const QString &presetId : presetIds) {
+        if (rowOf(presetId) < 0) {
+            // Removed, remember when so incremental readers can drop it too
+            m_revisions.remove(presetId);
+            m_tombstones.insert(presetId, m_revision);
+            continue;
+        }
+
+        m_tombstones.remove(presetId);
+        auto it = m_revisions.find(presetId);
+        if (it == m_revisions.end()) {
+            it = m_revisions.insert(presetId, PresetRevision());
+            it->added = m_revision;
+            it->configuration = m_revision;
+        }
+        PresetRevision &presetRevision = it.value();
+        presetRevision.latest = m_revision;
+        if (contentChanged) {
+            presetRevision.content = m_revision;
+        }
+        if (configurationChangedIds.contains(presetId)) {
+            presetRevision.configuration = m_revision;
+        }
+    }
 
-    if (it != m_presets.end()) {
-        return *it;
+    // Forget the oldest removals, readers older than that have to start over
+    while (m_tombstones.count() > s_maxTombstones) {
+        auto oldest = std::min_element(m_tombstones.begin(), m_tombstones.end());
+        m_tombstoneFloor = qMax(m_tombstoneFloor, oldest.value());
+        m_tombstones.erase(oldest);
+    }
+}
+
+DisplayPreset Presets::getPreset(const QString &presetId) const
+{
+    if (const DisplayPreset *found = preset(presetId)) {
+        return *found;
     }
 
     return DisplayPreset{};
 }
 
-void Presets::updateLastUsed(const QString &presetId)
+const QList<DisplayPreset> &Presets::presets() const
 {
-    auto it = std::ranges::find_if(m_presets, [&presetId](const DisplayPreset &preset) {
-        return preset.id == presetId;
-    });
+    return m_presets;
+}
 
-    if (it != m_presets.end()) {
-        it->lastUsed = QDateTime::currentDateTime();
-        savePresetsToDisk();
+const DisplayPreset *Presets::preset(const QString &presetId) const
+{
+    const int row = rowOf(presetId);
+    return row >= 0 ? &m_presets.at(row) : nullptr;
+}
+
+int Presets::rowOf(const QString &presetId) const
+{
+    return m_rowById.value(presetId, -1);
+}
+
+void Presets::rebuildIndexes()
+{
+    m_rowById.clear();
+    m_rowByName.clear();
+    m_rowById.reserve(m_presets.count());
+    m_rowByName.reserve(m_presets.count());
+
+    for (int row = 0; row < m_presets.count(); ++row) {
+        indexRow(row);
+    }
+}
+
+void Presets::reindexFrom(int first)
+{
+    for (auto it = m_rowByName.begin(); it != m_rowByName.end();) {
+        it = it.value() >= first ? m_rowByName.erase(it) : std::next(it);
+    }
+    for (int row = first; row < m_presets.count(); ++row) {
+        indexRow(row);
+    }
+}
+
+void Presets::indexRow(int row)
+{
+    const DisplayPreset &preset = m_presets.at(row);
+    m_rowById.insert(preset.id, row);
+    // The first preset with a given name wins, like the linear search it replaces
+    if (!m_rowByName.contains(preset.name)) {
+        m_rowByName.insert(preset.name, row);
+    }
+}
+
+void Presets::updateLastUsed(const QString &presetId, qint64 applyDuration)
+{
+    if (rowOf(presetId) < 0) {
+        return;
+    }
+
+    // One appended line instead of rewriting presets.json on every apply
+    m_usageJournal->setPresetIds(QSet<QString>(m_rowById.keyBegin(), m_rowById.keyEnd()));
+    syncUsage(m_usageJournal->record(presetId, QDateTime::currentDateTime(), applyDuration));
+
+    if (m_usageJournal->hasPendingRecords()) {
+        // Another process holds the journal, append with the next reload
+        m_usageJournalDirty = true;
+        m_reloadTimer->start();
+    }
+}
+
+void Presets::applyUsage(DisplayPreset &preset) const
+{
+    const PresetUsage usage = m_usageJournal->usage(preset.id);
+    // presets.json may still carry a lastUsed from before the journal existed
+    if (usage.lastUsed.isValid() && (!preset.lastUsed.isValid() || usage.lastUsed > preset.lastUsed)) {
+        preset.lastUsed = usage.lastUsed;
+    }
+    preset.applyCount = usage.applyCount;
+    preset.lastApplyDuration = usage.lastApplyDuration;
+}
+
+void Presets::syncUsage(const QStringList &presetIds)
+{
+    QStringList changedPresetIds;
+
+    for (const QString &presetId : presetIds) {
+        const int row = rowOf(presetId);
+        if (row < 0) {
+            continue;
+        }
+
+        DisplayPreset &preset = m_presets[row];
+        const QDateTime lastUsed = preset.lastUsed;
+        const int applyCount = preset.applyCount;
+        applyUsage(preset);
+
+        QList<int> roles;
+        if (preset.lastUsed != lastUsed) {
+            roles << LastUsedRole;
+        }
+        if (preset.applyCount != applyCount) {
+            roles << ApplyCountRole;
+        }
+        if (roles.isEmpty()) {
+            continue;
+        }
+
+        Q_EMIT dataChanged(index(row), index(row), roles);
+        changedPresetIds.append(presetId);
+    }
+
+    if (!changedPresetIds.isEmpty()) {
+        bumpRevision(changedPresetIds, true);
+        Q_EMIT presetsModified(changedPresetIds);
     }
 }
 
 void Presets::loadPresetsFromDisk()
 {
-    const QString filePath = presetsFilePath();
-    QFile file(filePath);
+    const QString jsonFilePath = presetsFilePath();
+    const QString storeFilePath = presetsStorePath();
+    const QFileInfo jsonInfo(jsonFilePath);
+    const QFileInfo storeInfo(storeFilePath);
+
+    // A JSON file newer than the binary store was written by hand or by an older version
+    const bool importJson =
+        jsonFilePath != storeFilePath && jsonInfo.exists() && (!storeInfo.exists() || jsonInfo.lastModified() > storeInfo.lastModified());
+    const QString filePath = importJson ? jsonFilePath : storeFilePath;
 
-    if (!file.exists()) {
+    if (!QFile::exists(filePath)) {
         return;
     }
 
-    if (!file.open(QIODevice::ReadOnly)) {
+    // Usually the watcher reporting our own write, recognized without reading the file
+    if (!importJson && m_storeSize >= 0 && storeInfo.size() == m_storeSize && storeInfo.lastModified() == m_storeModified) {
+        qCDebug(KDISPLAYPRESETS_COMMON) << "Presets store unchanged since last loaded or written, skipping reload";
+        return;
+    }
+
+    QString errorString;
+    const std::optional<PresetsStore::FileData> file = PresetsStore::readFile(filePath, &errorString);
+    if (!file) {
         const QString error = i18n("Could not open presets file for reading: %1", filePath);
-        qCWarning(KDISPLAYPRESETS_COMMON) << error;
+        qCWarning(KDISPLAYPRESETS_COMMON) << error << errorString;
         Q_EMIT loadingFailed(error);
         return;
     }
 
-    QJsonParseError parseError;
-    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
-    if (parseError.error != QJsonParseError::NoError) {
-        const QString error = i18n("Error parsing presets file: %1", parseError.errorString());
+    const QByteArray contentHash = PresetsWriter::contentHash(file->data);
+    if (contentHash == m_contentHash) {
+        qCDebug(KDISPLAYPRESETS_COMMON) << "Presets file content unchanged, skipping reload";
+        if (!importJson) {
+            m_storeSize = storeInfo.size();
+            m_storeModified = storeInfo.lastModified();
+        }
+        return;
+    }
+
+    std::optional<QList<DisplayPreset>> presets = PresetsStore::parse(*file, PresetsStore::formatForPath(filePath), &errorString);
+    if (!presets) {
+        const QString error = i18n("Error parsing presets file: %1", errorString);
         qCWarning(KDISPLAYPRESETS_COMMON) << error;
         Q_EMIT loadingFailed(error);
         return;
     }
 
-    const QJsonObject root = doc.object();
-    const QJsonArray presetsArray = root[QStringLiteral("presets")].toArray();
-
-    beginResetModel();
-    m_presets.clear();
+    m_contentHash = contentHash;
+    // Taken before reading, a replacement in between only costs one more read
+    m_storeSize = importJson ? -1 : storeInfo.size();
+    m_storeModified = importJson ? QDateTime() : storeInfo.lastModified();
 
-    for (const QJsonValue &value : presetsArray) {
-        const QJsonObject presetObj = value.toObject();
-        DisplayPreset preset;
-        preset.id = presetObj[QStringLiteral("id")].toString();
-        preset.name = presetObj[QStringLiteral("name")].toString();
-        preset.description = presetObj[QStringLiteral("description")].toString();
-        preset.created = QDateTime::fromString(presetObj[QStringLiteral("created")].toString(), Qt::ISODate);
-        preset.lastUsed = QDateTime::fromString(presetObj[QStringLiteral("lastUsed")].toString(), Qt::ISODate);
-        preset.configuration = presetObj[QStringLiteral("configuration")].toObject().toVariantMap();
-        preset.shortcut = QKeySequence(presetObj[QStringLiteral("shortcut")].toString());
-
-        // Extract output IDs
-        const QJsonArray outputIds = presetObj[QStringLiteral("outputIds")].toArray();
-        for (const QJsonValue &outputId : outputIds) {
-            preset.outputIds.append(outputId.toString());
-        }
+    for (DisplayPreset &preset : *presets) {
+        applyUsage(preset);
+    }
+    mergePresets(*presets);
 
-        m_presets.append(preset);
+    if (importJson) {
+        qCDebug(KDISPLAYPRESETS_COMMON) << "Migrating presets from" << jsonFilePath << "to" << storeFilePath;
+        m_jsonMigrationPending = true;
+        savePresetsToDisk();
     }
+}
 
-    endResetModel();
-    Q_EMIT presetsChanged();
+void Presets::retireMigratedJson()
+{
+    // Left in place, any later touch of the old file would make it look newer
+    // than the store and import its stale content over everything since
+    const QString jsonFilePath = presetsFilePath();
+    const QString migratedFilePath = jsonFilePath + QStringLiteral(".migrated");
+    QFile::remove(migratedFilePath);
+    if (!QFile::rename(jsonFilePath, migratedFilePath)) {
+        qCWarning(KDISPLAYPRESETS_COMMON) << "Could not move migrated presets file" << jsonFilePath << "out of the way";
+    }
 }
 
-void Presets::savePresetsToDisk()
+void Presets::mergePresets(const QList<DisplayPreset> &presets)
 {
-    const QString filePath = presetsFilePath();
-    QFile file(filePath);
+    QStringList changedPresetIds;
+    QStringList configurationChangedIds;
 
-    // Create directory if it doesn't exist
-    QDir dir = QFileInfo(filePath).absoluteDir();
-    if (!dir.exists()) {
-        dir.mkpath(QStringLiteral("."));
+    QSet<QString> presetIds;
+    presetIds.reserve(presets.count());
+    for (const DisplayPreset &preset : presets) {
+        presetIds.insert(preset.id);
     }
 
-    if (!file.open(QIODevice::WriteOnly)) {
-        const QString error = i18n("Could not open presets file for writing: %1", filePath);
-        qCWarning(KDISPLAYPRESETS_COMMON) << error;
-        Q_EMIT savingFailed(error);
-        return;
+    // Drop rows whose preset is gone
+    for (int row = m_presets.count() - 1; row >= 0; --row) {
+        const QString presetId = m_presets.at(row).id;
+        if (!presetIds.contains(presetId)) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_presets.removeAt(row);
+            m_rowById.remove(presetId);
+            reindexFrom(row);
+            m_presetStatus.remove(presetId);
+            endRemoveRows();
+            changedPresetIds.append(presetId);
+        }
     }
 
-    QJsonArray presetsArray;
-    for (const DisplayPreset &preset : m_presets) {
-        QJsonObject presetObj;
-        presetObj[QStringLiteral("id")] = preset.id;
-        presetObj[QStringLiteral("name")] = preset.name;
-        presetObj[QStringLiteral("description")] = preset.description;
-        presetObj[QStringLiteral("created")] = preset.created.toString(Qt::ISODate);
-        presetObj[QStringLiteral("lastUsed")] = preset.lastUsed.toString(Qt::ISODate);
-        presetObj[QStringLiteral("configuration")] = QJsonObject::fromVariantMap(preset.configuration);
-        presetObj[QStringLiteral("shortcut")] = preset.shortcut.toString();
-
-        QJsonArray outputIds;
-        for (const QString &outputId : preset.outputIds) {
-            outputIds.append(outputId);
+    // Walk the new order, moving, inserting or updating rows in place
+    for (int row = 0; row < presets.count(); ++row) {
+        const DisplayPreset &preset = presets.at(row);
+
+        // Rows before this one are final, so an existing preset is at or after it
+        const int currentRow = rowOf(preset.id);
+
+        if (currentRow < 0) {
+            beginInsertRows(QModelIndex(), row, row);
+            m_presets.insert(row, preset);
+            reindexFrom(row);
+            m_presetStatus.insert(preset.id, evaluatePresetStatus(preset));
+            endInsertRows();
+            changedPresetIds.append(preset.id);
+            continue;
+        }
+
+        if (currentRow != row) {
+            beginMoveRows(QModelIndex(), currentRow, currentRow, QModelIndex(), row);
+            m_presets.move(currentRow, row);
+            reindexFrom(row);
+            endMoveRows();
         }
-        presetObj[QStringLiteral("outputIds")] = outputIds;
 
-        presetsArray.append(presetObj);
+        QList<int> roles = changedRoles(m_presets.at(row), preset);
+        if (roles.isEmpty()) {
+            continue;
+        }
+
+        m_presets[row] = preset;
+        if (roles.contains(NameRole)) {
+            reindexFrom(row);
+        }
+        if (roles.contains(ConfigurationRole)) {
+            configurationChangedIds.append(preset.id);
+        }
+
+        // Availability is checked against outputIds, the current state against the configuration
+        if (roles.contains(ConfigurationRole) || roles.contains(OutputCountRole)) {
+            const PresetStatus status = evaluatePresetStatus(preset);
+            PresetStatus &cachedStatus = m_presetStatus[preset.id];
+            if (cachedStatus.available != status.available || cachedStatus.current != status.current) {
+                cachedStatus = status;
+                roles << IsAvailableRole << IsCurrentRole;
+            }
+        }
+
+        Q_EMIT dataChanged(index(row), index(row), roles);
+        changedPresetIds.append(preset.id);
     }
 
-    QJsonObject root;
-    root[QStringLiteral("version")] = 1;
-    root[QStringLiteral("presets")] = presetsArray;
+    if (changedPresetIds.isEmpty()) {
+        return;
+    }
 
-    QJsonDocument doc(root);
-    file.write(doc.toJson());
+    qCDebug(KDISPLAYPRESETS_COMMON) << "Presets changed on disk:" << changedPresetIds;
+    bumpRevision(changedPresetIds, true, configurationChangedIds);
+    Q_EMIT presetsModified(changedPresetIds);
+    Q_EMIT presetsChanged();
+}
 
-    // Ensure the file is watched after creation/modification
-    if (!m_fileWatcher->files().contains(filePath)) {
-        m_fileWatcher->addPath(filePath);
+QList<int> Presets::changedRoles(const DisplayPreset &oldPreset, const DisplayPreset &newPreset)
+{
+    QList<int> roles;
+    if (oldPreset.name != newPreset.name) {
+        roles << NameRole;
+    }
+    if (oldPreset.description != newPreset.description) {
+        roles << DescriptionRole;
+    }
+    if (oldPreset.created != newPreset.created) {
+        roles << CreatedRole;
+    }
+    if (oldPreset.lastUsed != newPreset.lastUsed) {
+        roles << LastUsedRole;
+    }
+    if (oldPreset.applyCount != newPreset.applyCount) {
+        roles << ApplyCountRole;
+    }
+    if (oldPreset.outputIds != newPreset.outputIds) {
+        roles << OutputCountRole;
     }
+    if (!(oldPreset.configuration == newPreset.configuration)) {
+        roles << ConfigurationRole << PreviewGeometryRole;
+    }
+    if (oldPreset.shortcut != newPreset.shortcut) {
+        roles << ShortcutRole;
+    }
+    return roles;
+}
+
+void Presets::savePresetsToDisk()
+{
+    m_writer->schedule(presetsStorePath(), m_presets);
 }
 
 QString Presets::presetsFilePath() const
@@ -425,84 +823,154 @@ QString Presets::presetsFilePath() const
     return dataDir + QStringLiteral("/kdisplaypresets/presets.json");
 }
 
-void Presets::onPresetFileChanged()
+QString Presets::presetsStorePath() const
 {
-    const QString filePath = presetsFilePath();
-    if (!QFile::exists(filePath)) {
-        // File was deleted, clear presets
-        beginResetModel();
-        m_presets.clear();
-        endResetModel();
-        Q_EMIT presetsChanged();
+    return PresetsStore::binaryPathFor(presetsFilePath());
+}
+
+QString Presets::usageJournalPath() const
+{
+    return presetsFilePath() + QStringLiteral(".usage");
+}
+
+void Presets::onPresetFileChanged(const QString &path)
+{
+    // An apply only touches the journal, which does not need presets.json re-read
+    if (path == m_usageJournal->filePath()) {
+        m_usageJournalDirty = true;
+    } else {
+        m_presetsFileDirty = true;
+    }
+
+    // Coalesce bursts of watcher events into a single reload
+    m_reloadTimer->start();
+}
+
+void Presets::reloadPresetsFile()
+{
+    // Let our own pending write land first, it is newer than what is on disk
+    if (m_writer->hasPendingWrites()) {
+        m_reloadTimer->start();
         return;
     }
 
     // Re-add the file to watcher since Qt removes it after modification
-    if (!m_fileWatcher->files().contains(filePath)) {
-        m_fileWatcher->addPath(filePath);
+    watchPresetsFile();
+
+    if (std::exchange(m_usageJournalDirty, false)) {
+        syncUsage(m_usageJournal->flush());
+        if (m_usageJournal->hasPendingRecords()) {
+            m_usageJournalDirty = true;
+            m_reloadTimer->start();
+        }
+    }
+
+    if (!std::exchange(m_presetsFileDirty, false)) {
+        return;
+    }
+
+    if (!QFile::exists(presetsStorePath()) && !QFile::exists(presetsFilePath())) {
+        // File was deleted, clear presets
+        m_contentHash.clear();
+        m_storeSize = -1;
+        m_storeModified = QDateTime();
+        mergePresets({});
+        return;
     }
 
-    // Reload presets from disk
+    // Reload presets from disk, skipped when the content hash is unchanged
     loadPresetsFromDisk();
-    Q_EMIT presetsChanged();
+}
+
+void Presets::watchPresetsFile()
+{
+    const QString filePath = presetsFilePath();
+    for (const QString &path : {filePath, presetsStorePath(), m_usageJournal->filePath()}) {
+        if (QFile::exists(path) && !m_fileWatcher->files().contains(path)) {
+            m_fileWatcher->addPath(path);
+        }
+    }
+
+    // Watching the directory catches the file being created or replaced by another process
+    const QString dirPath = QFileInfo(filePath).absolutePath();
+    if (QFileInfo::exists(dirPath) && !m_fileWatcher->directories().contains(dirPath)) {
+        m_fileWatcher->addPath(dirPath);
+    }
 }
 
 void Presets::addPreset(const DisplayPreset &preset)
 {
-    beginInsertRows(QModelIndex(), m_presets.count(), m_presets.count());
+    const int row = m_presets.count();
+    beginInsertRows(QModelIndex(), row, row);
     m_presets.append(preset);
+    indexRow(row);
+    m_presetStatus.insert(preset.id, evaluatePresetStatus(preset));
     endInsertRows();
+    bumpRevision({preset.id}, true);
+    Q_EMIT presetsModified({preset.id});
     Q_EMIT presetsChanged();
 }
 
 void Presets::updatePreset(const QString &presetId, const DisplayPreset &preset)
 {
-    auto it = std::ranges::find_if(m_presets, [&presetId](const DisplayPreset &p) {
-        return p.id == presetId;
-    });
+    // Copy, callers may pass a reference into the preset being replaced
+    const QString previousId = presetId;
+    const int row = rowOf(previousId);
+    if (row < 0) {
+        return;
+    }
 
-    if (it != m_presets.end()) {
-        const int row = std::distance(m_presets.begin(), it);
-        m_presets[row] = preset;
-        Q_EMIT dataChanged(index(row), index(row));
-        Q_EMIT presetsChanged();
+    const bool keysChanged = previousId != preset.id || m_presets.at(row).name != preset.name;
+    const bool configurationChanged = !(m_presets.at(row).configuration == preset.configuration);
+    m_presets[row] = preset;
+    if (keysChanged) {
+        rebuildIndexes();
     }
+
+    m_presetStatus.remove(previousId);
+    m_presetStatus.insert(preset.id, evaluatePresetStatus(preset));
+    Q_EMIT dataChanged(index(row), index(row));
+    const QStringList changedPresetIds = previousId == preset.id ? QStringList{previousId} : QStringList{previousId, preset.id};
+    bumpRevision(changedPresetIds, true, configurationChanged ? QStringList{preset.id} : QStringList());
+    Q_EMIT presetsModified(changedPresetIds);
+    Q_EMIT presetsChanged();
 }
 
 void Presets::removePreset(const QString &presetId)
 {
-    auto it = std::ranges::find_if(m_presets, [&presetId](const DisplayPreset &preset) {
-        return preset.id == presetId;
-    });
-
-    if (it != m_presets.end()) {
-        const int row = std::distance(m_presets.begin(), it);
-        beginRemoveRows(QModelIndex(), row, row);
-        m_presets.erase(it);
-        endRemoveRows();
-        Q_EMIT presetsChanged();
+    const int row = rowOf(presetId);
+    if (row < 0) {
+        return;
     }
+
+    beginRemoveRows(QModelIndex(), row, row);
+    m_presets.removeAt(row);
+    rebuildIndexes();
+    m_presetStatus.remove(presetId);
+    endRemoveRows();
+    bumpRevision({presetId}, true);
+    Q_EMIT presetsModified({presetId});
+    Q_EMIT presetsChanged();
 }
 
 DisplayPreset *Presets::findPreset(const QString &presetId)
 {
-    auto it = std::ranges::find_if(m_presets, [&presetId](const DisplayPreset &preset) {
-        return preset.id == presetId;
-    });
-
-    return it != m_presets.end() ? &(*it) : nullptr;
+    const int row = rowOf(presetId);
+    return row >= 0 ? &m_presets[row] : nullptr;
 }
 
 DisplayPreset *Presets::findPresetByName(const QString &name)
 {
-    auto it = std::ranges::find_if(m_presets, [&name](const DisplayPreset &preset) {
-        return preset.name == name;
-    });
-
-    return it != m_presets.end() ? &(*it) : nullptr;
+    const int row = m_rowByName.value(name, -1);
+    return row >= 0 ? &m_presets[row] : nullptr;
 }
 
 void Presets::saveToDisk()
 {
     savePresetsToDisk();
 }
+
+void Presets::flush()
+{
+    m_writer->flush();
+}
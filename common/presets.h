@@ -5,6 +5,9 @@
 */
 #pragma once
 
+#include "presetconfiguration.h"
+#include "usagejournal.h"
+
 #include <KScreen/Config>
 
 #include <QAbstractListModel>
@@ -13,7 +16,11 @@
 #include <QKeySequence>
 #include <QString>
 #include <QStringList>
-#include <QVariantMap>
+
+#include <memory>
+
+class PresetsWriter;
+class QTimer;
 
 struct DisplayPreset {
     QString id;
@@ -22,8 +29,11 @@ struct DisplayPreset {
     QDateTime created;
     QDateTime lastUsed;
     QStringList outputIds;
-    QVariantMap configuration;
+    PresetConfiguration configuration;
     QKeySequence shortcut;
+    // Usage counters, kept in the usage journal rather than in presets.json
+    int applyCount = 0;
+    qint64 lastApplyDuration = -1;
 
     bool operator==(const DisplayPreset &other) const
     {
@@ -48,11 +58,15 @@ public:
         OutputCountRole,
         ConfigurationRole,
         ShortcutRole,
+        IsAvailableRole,
+        IsCurrentRole,
+        ApplyCountRole,
+        PreviewGeometryRole,
     };
     Q_ENUM(PresetRoles)
 
     explicit Presets(QObject *parent = nullptr, const QString &customFilePath = QString());
-    ~Presets() override = default;
+    ~Presets() override;
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
@@ -65,37 +79,149 @@ public:
     KScreen::ConfigPtr screenConfiguration() const;
     void setScreenConfiguration(KScreen::ConfigPtr config);
 
+    // Revisions grow with every change reported by presetsModified() or presetStatusChanged()
+    quint64 revision() const;
+    quint64 presetRevision(const QString &presetId) const;
+    // Last revision that changed the preset itself rather than only its status
+    quint64 presetContentRevision(const QString &presetId) const;
+    // Last revision that changed the preset's configuration, usage and metadata edits leave it alone
+    quint64 presetConfigurationRevision(const QString &presetId) const;
+    quint64 presetAddedRevision(const QString &presetId) const;
+    QStringList presetsChangedSince(quint64 revision) const;
+    QStringList presetsRemovedSince(quint64 revision) const;
+    // Removals at or before this revision are no longer tracked
+    quint64 oldestTrackedRevision() const;
+
     Q_INVOKABLE DisplayPreset getPreset(const QString &presetId) const;
-    Q_INVOKABLE void updateLastUsed(const QString &presetId);
+    // Non-copying lookups, the pointer is valid until the model changes
+    const QList<DisplayPreset> &presets() const;
+    const DisplayPreset *preset(const QString &presetId) const;
+    int rowOf(const QString &presetId) const;
+    // Records a use of the preset; applyDuration is in milliseconds, -1 if unknown
+    Q_INVOKABLE void updateLastUsed(const QString &presetId, qint64 applyDuration = -1);
     Q_INVOKABLE void refreshPresetStatus();
 
-    // Methods for preset manipulation
+    // Methods for preset manipulation. Change id or name only through updatePreset(),
+    // pointers returned by findPreset() bypass the lookup indexes.
     void addPreset(const DisplayPreset &preset);
     void updatePreset(const QString &presetId, const DisplayPreset &preset);
     void removePreset(const QString &presetId);
     DisplayPreset *findPreset(const QString &presetId);
     DisplayPreset *findPresetByName(const QString &name);
     void saveToDisk();
+    // Blocks until all scheduled saves have been written
+    void flush();
 
 Q_SIGNALS:
     void presetsChanged();
+    // Presets that were added, modified or removed, reported together with presetsChanged()
+    void presetsModified(const QStringList &presetIds);
+    void presetStatusChanged(const QStringList &presetIds);
     void screenConfigurationChanged();
     void loadingFailed(const QString &error);
     void savingFailed(const QString &error);
 
 protected:
     void loadPresetsFromDisk();
+    void mergePresets(const QList<DisplayPreset> &presets);
+    void retireMigratedJson();
     void savePresetsToDisk();
+    // JSON file from older versions, only read to import it into the store
     QString presetsFilePath() const;
+    // Binary store the presets are saved to
+    QString presetsStorePath() const;
+    QString usageJournalPath() const;
 
 private Q_SLOTS:
-    void onPresetFileChanged();
+    void onPresetFileChanged(const QString &path);
+    void reloadPresetsFile();
 
 protected:
     QList<DisplayPreset> m_presets;
     KScreen::ConfigPtr m_screenConfiguration;
 
 private:
+    // State of a connected output captured when the screen configuration is set
+    struct OutputSnapshot {
+        QString name;
+        bool enabled = false;
+        uint32_t priority = 0;
+        QPoint pos;
+        bool hasMode = false;
+        QSize modeSize;
+        float refreshRate = 0.0f;
+        qreal scale = 1.0;
+        KScreen::Output::Rotation rotation = KScreen::Output::None;
+
+        bool operator==(const OutputSnapshot &other) const = default;
+    };
+
+    struct PresetRevision {
+        quint64 added = 0;
+        quint64 latest = 0;
+        quint64 content = 0;
+        quint64 configuration = 0;
+    };
+
+    // Cached result of the availability/current checks for one preset
+    struct PresetStatus {
+        bool available = false;
+        bool current = false;
+    };
+
+    // True if the index differs from the one it replaced
+    bool rebuildOutputIndex();
+    void rebuildIndexes();
+    void indexRow(int row);
+    // Rows from first on were shifted, inserted or renamed, the ones before are unchanged
+    void reindexFrom(int first);
+    PresetStatus evaluatePresetStatus(const DisplayPreset &preset) const;
+    bool evaluateAvailable(const DisplayPreset &preset) const;
+    bool evaluateCurrent(const DisplayPreset &preset) const;
+    const OutputSnapshot *matchOutput(const PresetOutputSpec &presetOutput) const;
+    void updatePresetStatus();
+    void watchPresetsFile();
+    void applyUsage(DisplayPreset &preset) const;
+    void syncUsage(const QStringList &presetIds);
+    static QList<int> changedRoles(const DisplayPreset &oldPreset, const DisplayPreset &newPreset);
+    // configurationChangedIds is the subset of presetIds whose configuration changed
+    void bumpRevision(const QStringList &presetIds, bool contentChanged, const QStringList &configurationChangedIds = {});
+
+    // Rows of m_presets keyed by preset id and by name
+    QHash<QString, int> m_rowById;
+    QHash<QString, int> m_rowByName;
+
+    // Connected outputs of m_screenConfiguration keyed by Output::hashMd5(),
+    // identical monitors share a hash and so an entry
+    QHash<QString, QList<OutputSnapshot>> m_outputIndex;
+    int m_enabledOutputCount = 0;
+
+    // Status of every preset, valid for configuration generation m_statusGeneration.
+    // The generation only moves when the outputs status is evaluated against do.
+    QHash<QString, PresetStatus> m_presetStatus;
+    quint64 m_configGeneration = 0;
+    quint64 m_statusGeneration = 0;
+
+    quint64 m_revision = 0;
+    QHash<QString, PresetRevision> m_revisions;
+    // Removed presets and the revision they were removed in
+    QHash<QString, quint64> m_tombstones;
+    quint64 m_tombstoneFloor = 0;
+
     QFileSystemWatcher *m_fileWatcher;
+    QTimer *m_reloadTimer;
+    PresetsWriter *m_writer;
     QString m_customPresetsFilePath;
+    // Hash of the file content last loaded or written by this instance
+    QByteArray m_contentHash;
+    // Size and modification time of that store file, -1 and invalid if unknown
+    qint64 m_storeSize = -1;
+    QDateTime m_storeModified;
+    // Imported presets.json, renamed away once the store holding it is written
+    bool m_jsonMigrationPending = false;
+
+    std::unique_ptr<UsageJournal> m_usageJournal;
+    // What the next reload has to look at, set from watcher events
+    bool m_presetsFileDirty = false;
+    bool m_usageJournalDirty = false;
 };
@@ -0,0 +1,267 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "presetsstore.h"
+
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborStreamReader>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+static constexpr int s_jsonVersion = 1;
+static constexpr int s_cborVersion = 2;
+
+static QString readString(QCborStreamReader &reader)
+{
+    if (!reader.isString()) {
+        reader.next();
+        return QString();
+    }
+
+    QString result;
+    auto chunk = reader.readString();
+    while (chunk.status == QCborStreamReader::Ok) {
+        result += chunk.data;
+        chunk = reader.readString();
+    }
+    return result;
+}
+
+static QDateTime readDateTime(QCborStreamReader &reader)
+{
+    return QDateTime::fromString(readString(reader), Qt::ISODate);
+}
+
+static QStringList readStringList(QCborStreamReader &reader)
+{
+    QStringList result;
+    if (!reader.isArray() || !reader.enterContainer()) {
+        reader.next();
+        return result;
+    }
+
+    while (reader.lastError() == QCborError::NoError && reader.hasNext()) {
+        result.append(readString(reader));
+    }
+    reader.leaveContainer();
+    return result;
+}
+
+static DisplayPreset readCborPreset(QCborStreamReader &reader, const PresetsStore::FileData &file)
+{
+    DisplayPreset preset;
+    if (!reader.isMap() || !reader.enterContainer()) {
+        reader.next();
+        return preset;
+    }
+
+    while (reader.lastError() == QCborError::NoError && reader.hasNext()) {
+        const QString key = readString(reader);
+
+        if (key == QLatin1String("id")) {
+            preset.id = readString(reader);
+        } else if (key == QLatin1String("name")) {
+            preset.name = readString(reader);
+        } else if (key == QLatin1String("description")) {
+            preset.description = readString(reader);
+        } else if (key == QLatin1String("created")) {
+            preset.created = readDateTime(reader);
+        } else if (key == QLatin1String("lastUsed")) {
+            preset.lastUsed = readDateTime(reader);
+        } else if (key == QLatin1String("shortcut")) {
+            preset.shortcut = QKeySequence(readString(reader));
+        } else if (key == QLatin1String("outputIds")) {
+            preset.outputIds = readStringList(reader);
+        } else if (key == QLatin1String("configuration")) {
+            // Skip over the map and point at its bytes, it is decoded on first use
+            const qint64 start = reader.currentOffset();
+            reader.next();
+            const qint64 end = reader.currentOffset();
+            const QByteArray encoded = file.storage ? QByteArray::fromRawData(file.data.constData() + start, end - start) : file.data.sliced(start, end - start);
+            preset.configuration = PresetConfiguration::fromCbor(encoded, file.storage);
+        } else {
+            reader.next();
+        }
+    }
+    reader.leaveContainer();
+
+    return preset;
+}
+
+static std::optional<QList<DisplayPreset>> parseCbor(const PresetsStore::FileData &file, QString *errorString)
+{
+    QList<DisplayPreset> presets;
+
+    QCborStreamReader reader(file.data);
+    if (!reader.isMap() || !reader.enterContainer()) {
+        *errorString = QStringLiteral("Not a presets store");
+        return std::nullopt;
+    }
+
+    while (reader.lastError() == QCborError::NoError && reader.hasNext()) {
+        const QString key = readString(reader);
+
+        if (key == QLatin1String("version") && reader.isUnsignedInteger()) {
+            if (reader.toUnsignedInteger() > s_cborVersion) {
+                *errorString = QStringLiteral("Unsupported presets store version %1").arg(quint64(reader.toUnsignedInteger()));
+                return std::nullopt;
+            }
+            reader.next();
+        } else if (key == QLatin1String("presets") && reader.isArray()) {
+            if (reader.isLengthKnown()) {
+                presets.reserve(reader.length());
+            }
+            reader.enterContainer();
+            while (reader.lastError() == QCborError::NoError && reader.hasNext()) {
+                presets.append(readCborPreset(reader, file));
+            }
+            reader.leaveContainer();
+        } else {
+            reader.next();
+        }
+    }
+
+    if (reader.lastError() != QCborError::NoError) {
+        *errorString = reader.lastError().toString();
+        return std::nullopt;
+    }
+
+    return presets;
+}
+
+static std::optional<QList<DisplayPreset>> parseJson(const PresetsStore::FileData &file, QString *errorString)
+{
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.data, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        *errorString = parseError.errorString();
+        return std::nullopt;
+    }
+
+    const QJsonObject root = doc.object();
+    const QJsonArray presetsArray = root[QStringLiteral("presets")].toArray();
+
+    QList<DisplayPreset> presets;
+    presets.reserve(presetsArray.size());
+
+    for (const QJsonValue &value : presetsArray) {
+        const QJsonObject presetObj = value.toObject();
+        DisplayPreset preset;
+        preset.id = presetObj[QStringLiteral("id")].toString();
+        preset.name = presetObj[QStringLiteral("name")].toString();
+        preset.description = presetObj[QStringLiteral("description")].toString();
+        preset.created = QDateTime::fromString(presetObj[QStringLiteral("created")].toString(), Qt::ISODate);
+        preset.lastUsed = QDateTime::fromString(presetObj[QStringLiteral("lastUsed")].toString(), Qt::ISODate);
+        preset.configuration = PresetConfiguration(presetObj[QStringLiteral("configuration")].toObject());
+        preset.shortcut = QKeySequence(presetObj[QStringLiteral("shortcut")].toString());
+
+        // Extract output IDs
+        const QJsonArray outputIds = presetObj[QStringLiteral("outputIds")].toArray();
+        for (const QJsonValue &outputId : outputIds) {
+            preset.outputIds.append(outputId.toString());
+        }
+
+        presets.append(preset);
+    }
+
+    return presets;
+}
+
+static QByteArray serializeJson(const QList<DisplayPreset> &presets)
+{
+    QJsonArray presetsArray;
+    for (const DisplayPreset &preset : presets) {
+        QJsonObject presetObj;
+        presetObj[QStringLiteral("id")] = preset.id;
+        presetObj[QStringLiteral("name")] = preset.name;
+        presetObj[QStringLiteral("description")] = preset.description;
+        presetObj[QStringLiteral("created")] = preset.created.toString(Qt::ISODate);
+        presetObj[QStringLiteral("lastUsed")] = preset.lastUsed.toString(Qt::ISODate);
+        presetObj[QStringLiteral("configuration")] = preset.configuration.toJson();
+        presetObj[QStringLiteral("shortcut")] = preset.shortcut.toString();
+
+        QJsonArray outputIds;
+        for (const QString &outputId : preset.outputIds) {
+            outputIds.append(outputId);
+        }
+        presetObj[QStringLiteral("outputIds")] = outputIds;
+
+        presetsArray.append(presetObj);
+    }
+
+    QJsonObject root;
+    root[QStringLiteral("version")] = s_jsonVersion;
+    root[QStringLiteral("presets")] = presetsArray;
+
+    return QJsonDocument(root).toJson();
+}
+
+static QByteArray serializeCbor(const QList<DisplayPreset> &presets)
+{
+    QCborArray presetsArray;
+    for (const DisplayPreset &preset : presets) {
+        QCborMap presetMap;
+        presetMap[QStringLiteral("id")] = preset.id;
+        presetMap[QStringLiteral("name")] = preset.name;
+        presetMap[QStringLiteral("description")] = preset.description;
+        presetMap[QStringLiteral("created")] = preset.created.toString(Qt::ISODate);
+        presetMap[QStringLiteral("lastUsed")] = preset.lastUsed.toString(Qt::ISODate);
+        presetMap[QStringLiteral("shortcut")] = preset.shortcut.toString();
+        presetMap[QStringLiteral("outputIds")] = QCborArray::fromStringList(preset.outputIds);
+        // Last, so loading the metadata never has to look past it
+        presetMap[QStringLiteral("configuration")] = preset.configuration.toCbor();
+
+        presetsArray.append(presetMap);
+    }
+
+    QCborMap root;
+    root[QStringLiteral("version")] = s_cborVersion;
+    root[QStringLiteral("presets")] = presetsArray;
+
+    return root.toCborValue().toCbor();
+}
+
+PresetsStore::Format PresetsStore::formatForPath(const QString &filePath)
+{
+    return filePath.endsWith(QLatin1String(".cbor"), Qt::CaseInsensitive) ? Format::Cbor : Format::Json;
+}
+
+QString PresetsStore::binaryPathFor(const QString &jsonFilePath)
+{
+    if (formatForPath(jsonFilePath) == Format::Cbor) {
+        return jsonFilePath;
+    }
+
+    const QFileInfo info(jsonFilePath);
+    return info.path() + QLatin1Char('/') + info.completeBaseName() + QStringLiteral(".cbor");
+}
+
+std::optional<PresetsStore::FileData> PresetsStore::readFile(const QString &filePath, QString *errorString)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *errorString = file.errorString();
+        return std::nullopt;
+    }
+
+    // Read rather than mapped: another tool truncating the file in place would
+    // otherwise take down every process still holding an undecoded configuration
+    auto storage = std::make_shared<const QByteArray>(file.readAll());
+    return FileData{*storage, storage};
+}
+
+std::optional<QList<DisplayPreset>> PresetsStore::parse(const FileData &file, Format format, QString *errorString)
+{
+    return format == Format::Cbor ? parseCbor(file, errorString) : parseJson(file, errorString);
+}
+
+QByteArray PresetsStore::serialize(const QList<DisplayPreset> &presets, Format format)
+{
+    return format == Format::Cbor ? serializeCbor(presets) : serializeJson(presets);
+}
@@ -0,0 +1,43 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "presets.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+#include <memory>
+#include <optional>
+
+// On-disk formats of the presets file. Presets are saved to the binary CBOR
+// store, which keeps every preset configuration encoded until it is first
+// used; JSON is read to import a presets.json written by an older version.
+namespace PresetsStore
+{
+enum class Format {
+    Json,
+    Cbor,
+};
+
+Format formatForPath(const QString &filePath);
+
+// Binary store kept next to a JSON presets file
+QString binaryPathFor(const QString &jsonFilePath);
+
+// File contents that parsed presets may keep referring to, storage owns the
+// buffer data points into
+struct FileData {
+    QByteArray data;
+    std::shared_ptr<const void> storage;
+};
+
+std::optional<FileData> readFile(const QString &filePath, QString *errorString);
+
+std::optional<QList<DisplayPreset>> parse(const FileData &file, Format format, QString *errorString);
+QByteArray serialize(const QList<DisplayPreset> &presets, Format format);
+}
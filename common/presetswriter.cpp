@@ -0,0 +1,124 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "presetswriter.h"
+#include "presetsstore.h"
+#include "kdisplaypresets_common_debug.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThread>
+#include <QTimer>
+
+// Edits made from the KCM (rename, then description) arrive back to back
+static constexpr int s_coalesceInterval = 200;
+
+PresetsWriter::PresetsWriter(QObject *parent)
+    : QObject(parent)
+    , m_coalesceTimer(new QTimer(this))
+    , m_thread(new QThread(this))
+    , m_worker(new QObject)
+{
+    m_thread->setObjectName(QStringLiteral("PresetsWriter"));
+    m_worker->moveToThread(m_thread);
+    m_thread->start(QThread::LowPriority);
+
+    m_coalesceTimer->setSingleShot(true);
+    m_coalesceTimer->setInterval(s_coalesceInterval);
+    connect(m_coalesceTimer, &QTimer::timeout, this, &PresetsWriter::submitPending);
+}
+
+PresetsWriter::~PresetsWriter()
+{
+    flush();
+
+    m_thread->quit();
+    m_thread->wait();
+    delete m_worker;
+}
+
+void PresetsWriter::schedule(const QString &filePath, const QList<DisplayPreset> &presets)
+{
+    // Implicitly shared snapshot, the GUI thread detaches on its next mutation
+    m_pendingFilePath = filePath;
+    m_pendingPresets = presets;
+    m_hasPending = true;
+
+    if (!m_coalesceTimer->isActive()) {
+        m_coalesceTimer->start();
+    }
+}
+
+void PresetsWriter::flush()
+{
+    m_coalesceTimer->stop();
+    submitPending();
+
+    // The worker processes writes in order, so an empty blocking call is a barrier
+    QMetaObject::invokeMethod(m_worker, [] { }, Qt::BlockingQueuedConnection);
+}
+
+bool PresetsWriter::hasPendingWrites() const
+{
+    return m_hasPending || m_inFlight > 0;
+}
+
+void PresetsWriter::submitPending()
+{
+    if (!m_hasPending) {
+        return;
+    }
+
+    const QString filePath = m_pendingFilePath;
+    const QList<DisplayPreset> presets = m_pendingPresets;
+    m_pendingPresets.clear();
+    m_hasPending = false;
+    ++m_inFlight;
+
+    QMetaObject::invokeMethod(m_worker, [this, filePath, presets] {
+        write(filePath, presets);
+    });
+}
+
+void PresetsWriter::write(const QString &filePath, const QList<DisplayPreset> &presets)
+{
+    // Runs on m_thread; results are delivered back to the owner's thread
+    const QByteArray data = PresetsStore::serialize(presets, PresetsStore::formatForPath(filePath));
+
+    QDir dir = QFileInfo(filePath).absoluteDir();
+    if (!dir.exists()) {
+        dir.mkpath(QStringLiteral("."));
+    }
+
+    // QSaveFile writes to a temporary file and renames it over the target on commit
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        const QString errorString = file.errorString();
+        qCWarning(KDISPLAYPRESETS_COMMON) << "Failed to write presets file" << filePath << errorString;
+        QMetaObject::invokeMethod(this, [this, filePath, errorString] {
+            --m_inFlight;
+            Q_EMIT writeFailed(filePath, errorString);
+        });
+        return;
+    }
+
+    qCDebug(KDISPLAYPRESETS_COMMON) << "Wrote" << presets.count() << "presets to" << filePath;
+    const QByteArray hash = contentHash(data);
+    // Another process may already have replaced the file, its stamp is not ours to report
+    const QFileInfo info(filePath);
+    const qint64 size = info.size() == data.size() ? info.size() : -1;
+    const QDateTime lastModified = size >= 0 ? info.lastModified() : QDateTime();
+    QMetaObject::invokeMethod(this, [this, filePath, hash, size, lastModified] {
+        --m_inFlight;
+        Q_EMIT written(filePath, hash, size, lastModified);
+    });
+}
+
+QByteArray PresetsWriter::contentHash(const QByteArray &data)
+{
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
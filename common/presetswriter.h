@@ -0,0 +1,57 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "presets.h"
+
+#include <QDateTime>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+class QThread;
+class QTimer;
+
+// Persists presets off the GUI thread. Bursts of schedule() calls within the
+// coalescing window collapse into a single write, which replaces the file
+// atomically so readers never see a half-written presets file.
+class PresetsWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PresetsWriter(QObject *parent = nullptr);
+    ~PresetsWriter() override;
+
+    void schedule(const QString &filePath, const QList<DisplayPreset> &presets);
+
+    // Blocks until every scheduled write has been committed to disk
+    void flush();
+
+    // True while a write is scheduled or has not been reported back yet
+    bool hasPendingWrites() const;
+
+    static QByteArray contentHash(const QByteArray &data);
+
+Q_SIGNALS:
+    // size and lastModified describe the committed file, they let a watcher
+    // event for this very write be recognized without reading the file
+    void written(const QString &filePath, const QByteArray &contentHash, qint64 size, const QDateTime &lastModified);
+    void writeFailed(const QString &filePath, const QString &errorString);
+
+private:
+    void submitPending();
+    void write(const QString &filePath, const QList<DisplayPreset> &presets);
+
+    QTimer *m_coalesceTimer = nullptr;
+    QThread *m_thread = nullptr;
+    QObject *m_worker = nullptr;
+
+    int m_inFlight = 0;
+    bool m_hasPending = false;
+    QString m_pendingFilePath;
+    QList<DisplayPreset> m_pendingPresets;
+};
@@ -0,0 +1,299 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "presetthumbnailprovider.h"
+
+#include <KLocalizedString>
+
+#include <QCache>
+#include <QColor>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFontMetricsF>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QPainter>
+#include <QQmlEngine>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QtMath>
+
+#include <mutex>
+
+static const QString s_providerId = QStringLiteral("kdisplaypresets");
+// Bump whenever drawThumbnail() changes so stale files on disk are not reused
+static const QByteArray s_renderVersion = QByteArrayLiteral("1");
+// PNG text entry holding the full image id and size a cached file was drawn for,
+// guards against a name collision
+static const QString s_keyText = QStringLiteral("Key");
+
+// Thumbnails are drawn at a few fixed heights in this range and scaled down by
+// Image, a step of a quarter keeps the text close to the size it was drawn at
+static constexpr int s_minimumHeight = 32;
+static constexpr int s_maximumHeight = 1024;
+static constexpr qreal s_heightStep = 1.25;
+
+// Files beyond these are removed once per process, redrawing one is cheap. A
+// file's modification time is when it was last drawn or read.
+static constexpr int s_maximumFiles = 256;
+static constexpr int s_maximumFileAgeDays = 30;
+
+namespace
+{
+struct ThumbnailTheme {
+    QColor background;
+    QColor text;
+    QColor highlight;
+    QColor highlightedText;
+};
+
+struct ThumbnailCache {
+    QMutex mutex;
+    // Cost is in bytes, a few hundred typical thumbnails fit
+    QCache<QString, QImage> images{16 * 1024 * 1024};
+};
+}
+
+Q_GLOBAL_STATIC(ThumbnailCache, s_cache)
+
+static QString cacheDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/kdisplaypresets/thumbnails");
+}
+
+// One file per layout, size, scale and colors, so the KCM and the applet or a
+// light and a dark theme do not keep redrawing each other's files
+static QString cacheFilePath(const QString &key)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(s_renderVersion);
+    hash.addData(key.toUtf8());
+    return cacheDirectory() + QLatin1Char('/') + QString::fromLatin1(hash.result().toHex()) + QStringLiteral(".png");
+}
+
+static void pruneCacheDirectory()
+{
+    const QFileInfoList files = QDir(cacheDirectory()).entryInfoList({QStringLiteral("*.png")}, QDir::Files, QDir::Time);
+    const QDateTime oldest = QDateTime::currentDateTime().addDays(-s_maximumFileAgeDays);
+    for (qsizetype i = 0; i < files.size(); ++i) {
+        // Sorted newest first
+        if (i >= s_maximumFiles || files.at(i).lastModified() < oldest) {
+            QFile::remove(files.at(i).filePath());
+        }
+    }
+}
+
+// Sizes follow the view while it is resized, only a few of them get drawn
+static int bucketHeight(int height)
+{
+    int bucket = s_minimumHeight;
+    while (bucket < height && bucket < s_maximumHeight) {
+        bucket = qCeil(bucket * s_heightStep);
+    }
+    return qMin(bucket, s_maximumHeight);
+}
+
+static QFont scaledFont(qreal pixelSize, bool bold = false)
+{
+    QFont font;
+    font.setPixelSize(qMax(1, qRound(pixelSize)));
+    font.setBold(bold);
+    return font;
+}
+
+// Follows PresetOutput.qml, sizes there are logical pixels hence the dpr factor
+static void drawOutput(QPainter &painter, const QRectF &rect, const QVariantMap &output, const ThumbnailTheme &theme, qreal dpr)
+{
+    const qreal logicalWidth = rect.width() / dpr;
+    const qreal logicalHeight = rect.height() / dpr;
+    const qreal border = 2 * dpr;
+
+    painter.setPen(QPen(theme.text, border));
+    painter.setBrush(theme.background);
+    painter.drawRoundedRect(rect.adjusted(border / 2, border / 2, -border / 2, -border / 2), border, border);
+
+    // Bottom bar as orientation indicator
+    painter.fillRect(QRectF(rect.left() + dpr, rect.bottom() - 3 * dpr, rect.width() - 2 * dpr, 2 * dpr), theme.text);
+
+    if (logicalWidth > 30 && logicalHeight > 20) {
+        const QFont font = scaledFont(qBound(6.0, logicalHeight / 8, 10.0) * dpr, true);
+        const QString priority = QString::number(output.value(QStringLiteral("priority"), 1).toUInt());
+        const QSizeF textSize = QFontMetricsF(font).size(Qt::TextSingleLine, priority);
+        const QRectF badge(rect.right() - border - textSize.width() - 4 * dpr, rect.top() + border, textSize.width() + 4 * dpr, textSize.height() + 2 * dpr);
+
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(theme.highlight);
+        painter.drawRoundedRect(badge, border, border);
+        painter.setFont(font);
+        painter.setPen(theme.highlightedText);
+        painter.drawText(badge, Qt::AlignCenter, priority);
+    }
+
+    struct Line {
+        QString text;
+        QFont font;
+        qreal opacity;
+    };
+    QList<Line> lines;
+
+    if (logicalHeight > 15) {
+        QString name = output.value(QStringLiteral("name")).toString();
+        if (name.isEmpty()) {
+            name = i18ndc("kdisplaypresets_common", "@label default monitor name", "Monitor");
+        }
+        lines.append({name, scaledFont(qBound(6.0, logicalHeight / 5, 12.0) * dpr), 1.0});
+    }
+
+    if (logicalHeight > 20) {
+        QString mode = output.value(QStringLiteral("modeLabel")).toString();
+        if (output.value(QStringLiteral("hdr")).toBool()) {
+            mode += QLatin1Char(' ') + i18ndc("kdisplaypresets_common", "@label HDR indicator", "HDR");
+        }
+        if (output.value(QStringLiteral("edr")).toBool()) {
+            mode += QLatin1Char(' ') + i18ndc("kdisplaypresets_common", "@label EDR indicator", "EDR");
+        }
+        lines.append({mode, scaledFont(qBound(5.0, logicalHeight / 6, 10.0) * dpr), 0.8});
+    }
+
+    if (logicalHeight > 25) {
+        lines.append({i18ndc("kdisplaypresets_common", "@info monitor scale factor", "Scale: %1%", output.value(QStringLiteral("scalePercent"), 100).toInt()),
+                      scaledFont(qBound(5.0, logicalHeight / 7, 9.0) * dpr),
+                      0.7});
+    }
+
+    const qreal spacing = qMax(1.0, logicalHeight / 15) * dpr;
+    const qreal textWidth = rect.width() - 2 * border;
+    qreal totalHeight = -spacing;
+    for (const Line &line : std::as_const(lines)) {
+        totalHeight += QFontMetricsF(line.font).height() + spacing;
+    }
+
+    qreal y = rect.center().y() - totalHeight / 2;
+    for (const Line &line : std::as_const(lines)) {
+        const QFontMetricsF metrics(line.font);
+        painter.setFont(line.font);
+        painter.setPen(theme.text);
+        painter.setOpacity(line.opacity);
+        painter.drawText(QRectF(rect.left() + border, y, textWidth, metrics.height()),
+                         Qt::AlignCenter,
+                         metrics.elidedText(line.text, Qt::ElideRight, textWidth));
+        y += metrics.height() + spacing;
+    }
+    painter.setOpacity(1.0);
+}
+
+static QImage drawThumbnail(const QVariantMap &geometry, const QSize &size, const ThumbnailTheme &theme, qreal dpr)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+
+    const QVariantList outputs = geometry.value(QStringLiteral("outputs")).toList();
+    for (const QVariant &entry : outputs) {
+        const QVariantMap output = entry.toMap();
+        const QRectF rect(output.value(QStringLiteral("x")).toDouble() * size.width(),
+                          output.value(QStringLiteral("y")).toDouble() * size.height(),
+                          output.value(QStringLiteral("width")).toDouble() * size.width(),
+                          output.value(QStringLiteral("height")).toDouble() * size.height());
+        drawOutput(painter, rect, output, theme, dpr);
+    }
+
+    return image;
+}
+
+PresetThumbnailProvider::PresetThumbnailProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image, QQuickImageProvider::ForceAsynchronousImageLoading)
+{
+    // Listing and removing files is kept off the GUI thread
+    static std::once_flag pruned;
+    std::call_once(pruned, []() {
+        QThreadPool::globalInstance()->start(pruneCacheDirectory);
+    });
+}
+
+QImage PresetThumbnailProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    const QStringList parts = id.split(QLatin1Char('/'));
+    if (parts.size() != 6) {
+        return QImage();
+    }
+
+    const QVariantMap geometry =
+        QJsonDocument::fromJson(QByteArray::fromBase64(parts[5].toLatin1(), QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals))
+            .toVariant()
+            .toMap();
+    const qreal aspectRatio = geometry.value(QStringLiteral("aspectRatio")).toDouble();
+    if (aspectRatio <= 0) {
+        return QImage();
+    }
+
+    const qreal dpr = qMax(1.0, parts[0].toDouble());
+    int height = requestedSize.height();
+    if (height <= 0) {
+        height = requestedSize.width() > 0 ? qRound(requestedSize.width() / aspectRatio) : qRound(90 * dpr);
+    }
+    height = bucketHeight(height);
+    const QSize imageSize(qMax(1, qRound(height * aspectRatio)), height);
+    if (size) {
+        *size = imageSize;
+    }
+
+    const QString key = id + QLatin1Char('@') + QString::number(imageSize.width()) + QLatin1Char('x') + QString::number(imageSize.height());
+    {
+        QMutexLocker locker(&s_cache->mutex);
+        if (const QImage *cached = s_cache->images.object(key)) {
+            return *cached;
+        }
+    }
+
+    const QString filePath = cacheFilePath(key);
+    QImage image(filePath);
+    if (image.text(s_keyText) == key) {
+        // Keeps files that are still in use out of the next prune
+        QFile file(filePath);
+        if (file.open(QIODevice::ReadWrite)) {
+            file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        }
+    } else {
+        const ThumbnailTheme theme{
+            QColor::fromString(QLatin1Char('#') + parts[1]),
+            QColor::fromString(QLatin1Char('#') + parts[2]),
+            QColor::fromString(QLatin1Char('#') + parts[3]),
+            QColor::fromString(QLatin1Char('#') + parts[4]),
+        };
+        image = drawThumbnail(geometry, imageSize, theme, dpr);
+        image.setText(s_keyText, key);
+
+        // The memory cache still serves it when the file cannot be written
+        QDir().mkpath(cacheDirectory());
+        QSaveFile file(filePath);
+        if (file.open(QIODevice::WriteOnly) && image.save(&file, "PNG")) {
+            file.commit();
+        }
+    }
+
+    QMutexLocker locker(&s_cache->mutex);
+    s_cache->images.insert(key, new QImage(image), image.sizeInBytes());
+    return image;
+}
+
+bool PresetThumbnailProvider::install(QObject *item)
+{
+    QQmlEngine *engine = qmlEngine(item);
+    if (!engine) {
+        return false;
+    }
+
+    if (!engine->imageProvider(s_providerId)) {
+        engine->addImageProvider(s_providerId, new PresetThumbnailProvider);
+    }
+    return true;
+}
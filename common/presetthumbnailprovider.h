@@ -0,0 +1,25 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include <QQuickImageProvider>
+
+// Draws a previewGeometry() layout once and keeps the image in memory and
+// under $XDG_CACHE_HOME/kdisplaypresets/thumbnails, so a list shows one Image
+// per preset instead of a subtree per output. Image ids are
+// "<devicePixelRatio>/<background>/<text>/<highlight>/<highlightedText>/<thumbnailKey>",
+// colors in hex without the leading '#'.
+class PresetThumbnailProvider : public QQuickImageProvider
+{
+public:
+    PresetThumbnailProvider();
+
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+
+    // Adds the provider to the engine item belongs to unless it already has
+    // one, false when item is not owned by a QML engine
+    static bool install(QObject *item);
+};
@@ -0,0 +1,54 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "previewgeometry.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRectF>
+
+static QVariantMap withThumbnailKey(QVariantMap geometry)
+{
+    const QByteArray json = QJsonDocument(QJsonObject::fromVariantMap(geometry)).toJson(QJsonDocument::Compact);
+    geometry.insert(QStringLiteral("thumbnailKey"), QString::fromLatin1(json.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals)));
+    return geometry;
+}
+
+QVariantMap previewGeometry(const PresetPreviewOutputList &outputs)
+{
+    QRectF bounds;
+    for (const PresetPreviewOutput &output : outputs) {
+        bounds |= QRectF(output.x, output.y, output.width, output.height);
+    }
+
+    if (bounds.isEmpty()) {
+        return withThumbnailKey(QVariantMap{
+            {QStringLiteral("aspectRatio"), 16.0 / 9.0},
+            {QStringLiteral("outputs"), QVariantList()},
+        });
+    }
+
+    QVariantList rects;
+    rects.reserve(outputs.count());
+    for (const PresetPreviewOutput &output : outputs) {
+        rects.append(QVariantMap{
+            {QStringLiteral("x"), (output.x - bounds.x()) / bounds.width()},
+            {QStringLiteral("y"), (output.y - bounds.y()) / bounds.height()},
+            {QStringLiteral("width"), output.width / bounds.width()},
+            {QStringLiteral("height"), output.height / bounds.height()},
+            {QStringLiteral("name"), output.name},
+            {QStringLiteral("modeLabel"), QStringLiteral("%1×%2 %3Hz").arg(output.modeWidth).arg(output.modeHeight).arg(qRound(output.refreshRate))},
+            {QStringLiteral("priority"), output.priority},
+            {QStringLiteral("scalePercent"), qRound(output.scale * 100)},
+            {QStringLiteral("hdr"), output.hdr},
+            {QStringLiteral("edr"), output.edr},
+        });
+    }
+
+    return withThumbnailKey(QVariantMap{
+        {QStringLiteral("aspectRatio"), bounds.width() / bounds.height()},
+        {QStringLiteral("outputs"), rects},
+    });
+}
@@ -0,0 +1,17 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "dbustypes.h"
+
+#include <QVariantMap>
+
+// Layout thumbnail ready for QML to place: "aspectRatio" of the whole layout
+// and "outputs", each with x, y, width and height as fractions of the layout
+// bounds, the "name" and "modeLabel" texts, "priority", "scalePercent" and the
+// "hdr" and "edr" flags. "thumbnailKey" encodes all of the above for
+// PresetThumbnailProvider, equal layouts share it.
+QVariantMap previewGeometry(const PresetPreviewOutputList &outputs);
@@ -0,0 +1,252 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "usagejournal.h"
+#include "kdisplaypresets_common_debug.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QUuid>
+
+#include <utility>
+
+// Roughly a few hundred records before they are folded into one line per preset
+static constexpr qint64 s_compactThreshold = 16 * 1024;
+
+static const QByteArray s_headerPrefix = QByteArrayLiteral("# kdisplaypresets usage journal ");
+
+static void applyRecord(PresetUsage &usage, const QDateTime &when, int count, qint64 applyDuration)
+{
+    usage.applyCount += count;
+    if (!usage.lastUsed.isValid() || when >= usage.lastUsed) {
+        usage.lastUsed = when;
+        if (applyDuration >= 0) {
+            usage.lastApplyDuration = applyDuration;
+        }
+    }
+}
+
+static QByteArray formatRecord(const QString &presetId, const QDateTime &when, int count, qint64 applyDuration)
+{
+    return presetId.toUtf8() + '\t' + QByteArray::number(when.toMSecsSinceEpoch()) + '\t' + QByteArray::number(count) + '\t'
+        + QByteArray::number(applyDuration) + '\n';
+}
+
+UsageJournal::UsageJournal(const QString &filePath)
+    : m_filePath(filePath)
+{
+}
+
+UsageJournal::~UsageJournal()
+{
+    // Last chance for records still waiting for the lock
+    if (hasPendingRecords()) {
+        flush();
+    }
+}
+
+QString UsageJournal::filePath() const
+{
+    return m_filePath;
+}
+
+PresetUsage UsageJournal::usage(const QString &presetId) const
+{
+    return m_usage.value(presetId);
+}
+
+QStringList UsageJournal::sync()
+{
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        // Journal removed (or never written), forget what was read from it
+        return resync(QByteArray(), QByteArray());
+    }
+
+    const QByteArray header = file.readLine();
+    if (header != m_header) {
+        return resync(header, file.readAll());
+    }
+
+    if (file.size() <= m_offset) {
+        return {};
+    }
+
+    file.seek(m_offset);
+    const QByteArray records = file.readAll();
+
+    // A writer may be halfway through its line, leave that for the next sync
+    const qsizetype end = records.lastIndexOf('\n') + 1;
+    m_offset += end;
+    return applyRecords(records.first(end));
+}
+
+QStringList UsageJournal::record(const QString &presetId, const QDateTime &when, qint64 applyDuration)
+{
+    // Counted right away, the line itself may have to wait for the lock
+    m_pendingRecords += formatRecord(presetId, when, 1, applyDuration);
+    applyRecord(m_usage[presetId], when, 1, applyDuration);
+
+    QStringList changedIds = flush();
+    if (!changedIds.contains(presetId)) {
+        changedIds.append(presetId);
+    }
+    return changedIds;
+}
+
+bool UsageJournal::hasPendingRecords() const
+{
+    return !m_pendingRecords.isEmpty();
+}
+
+QStringList UsageJournal::flush()
+{
+    if (m_pendingRecords.isEmpty()) {
+        return sync();
+    }
+
+    const QDir dir = QFileInfo(m_filePath).absoluteDir();
+    if (!dir.exists()) {
+        dir.mkpath(QStringLiteral("."));
+    }
+
+    // Serializes appends and compaction between the daemon and the KCM, never
+    // waited for since this runs on the GUI thread
+    QLockFile lock(m_filePath + QStringLiteral(".lock"));
+    if (!lock.tryLock(0)) {
+        qCDebug(KDISPLAYPRESETS_COMMON) << "Usage journal" << m_filePath << "is locked, keeping" << m_pendingRecords.count('\n') << "records for later";
+        return sync();
+    }
+
+    // Catch up first so the offset can move past our own records below
+    const QStringList changedIds = sync();
+
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qCWarning(KDISPLAYPRESETS_COMMON) << "Failed to open usage journal" << m_filePath << file.errorString();
+        return changedIds;
+    }
+
+    QByteArray data;
+    if (file.size() == 0) {
+        m_header = s_headerPrefix + QUuid::createUuid().toByteArray(QUuid::WithoutBraces) + '\n';
+        data = m_header;
+        m_offset = m_header.size();
+    }
+    data += m_pendingRecords;
+
+    if (file.write(data) != data.size() || !file.flush()) {
+        qCWarning(KDISPLAYPRESETS_COMMON) << "Failed to append to usage journal" << m_filePath << file.errorString();
+        return changedIds;
+    }
+
+    m_pendingRecords.clear();
+    m_offset = file.size();
+
+    if (m_offset > s_compactThreshold) {
+        file.close();
+        compact();
+    }
+
+    return changedIds;
+}
+
+void UsageJournal::setPresetIds(const QSet<QString> &presetIds)
+{
+    m_presetIds = presetIds;
+}
+
+QStringList UsageJournal::resync(const QByteArray &header, const QByteArray &records)
+{
+    // New or compacted journal: rebuild from scratch and report the difference
+    const QHash<QString, PresetUsage> previous = std::exchange(m_usage, {});
+    m_header = header;
+    m_offset = header.size();
+
+    const qsizetype end = records.lastIndexOf('\n') + 1;
+    m_offset += end;
+    applyRecords(records.first(end));
+    // Not on disk yet, still counted
+    applyRecords(m_pendingRecords);
+
+    QSet<QString> ids(previous.keyBegin(), previous.keyEnd());
+    for (auto it = m_usage.cbegin(); it != m_usage.cend(); ++it) {
+        ids.insert(it.key());
+    }
+
+    QStringList changedIds;
+    for (const QString &id : std::as_const(ids)) {
+        if (previous.value(id) != m_usage.value(id)) {
+            changedIds.append(id);
+        }
+    }
+    return changedIds;
+}
+
+QStringList UsageJournal::applyRecords(const QByteArray &records)
+{
+    QStringList changedIds;
+
+    qsizetype start = 0;
+    while (start < records.size()) {
+        qsizetype end = records.indexOf('\n', start);
+        if (end < 0) {
+            end = records.size();
+        }
+        const QList<QByteArray> fields = records.sliced(start, end - start).split('\t');
+        start = end + 1;
+
+        if (fields.size() != 4) {
+            continue;
+        }
+
+        bool timeOk = false;
+        bool countOk = false;
+        const QDateTime when = QDateTime::fromMSecsSinceEpoch(fields[1].toLongLong(&timeOk));
+        const int count = fields[2].toInt(&countOk);
+        if (!timeOk || !countOk || fields[0].isEmpty()) {
+            continue;
+        }
+
+        const QString presetId = QString::fromUtf8(fields[0]);
+        applyRecord(m_usage[presetId], when, count, fields[3].toLongLong());
+        if (!changedIds.contains(presetId)) {
+            changedIds.append(presetId);
+        }
+    }
+
+    return changedIds;
+}
+
+void UsageJournal::compact()
+{
+    // Caller holds the lock and has just synced, so m_usage covers every record.
+    // Presets deleted since are dropped here rather than carried forever.
+    if (m_presetIds) {
+        m_usage.removeIf([this](const QHash<QString, PresetUsage>::iterator &it) {
+            return !m_presetIds->contains(it.key());
+        });
+    }
+
+    const QByteArray header = s_headerPrefix + QUuid::createUuid().toByteArray(QUuid::WithoutBraces) + '\n';
+
+    QByteArray data = header;
+    for (auto it = m_usage.cbegin(); it != m_usage.cend(); ++it) {
+        data += formatRecord(it.key(), it->lastUsed, it->applyCount, it->lastApplyDuration);
+    }
+
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qCWarning(KDISPLAYPRESETS_COMMON) << "Failed to compact usage journal" << m_filePath << file.errorString();
+        return;
+    }
+
+    qCDebug(KDISPLAYPRESETS_COMMON) << "Compacted usage journal" << m_filePath << "to" << m_usage.count() << "records";
+    m_header = header;
+    m_offset = data.size();
+}
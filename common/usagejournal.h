@@ -0,0 +1,68 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include <optional>
+
+struct PresetUsage {
+    QDateTime lastUsed;
+    int applyCount = 0;
+    qint64 lastApplyDuration = -1; // milliseconds, -1 if unknown
+
+    bool operator==(const PresetUsage &other) const = default;
+};
+
+// Append-only log of preset applications, kept next to the presets file so
+// that recording a use costs one short line instead of a presets.json rewrite.
+//
+// Every line after the header is "<presetId>\t<msecs since epoch>\t<count>\t<duration ms>".
+// Once the file grows past a threshold it is compacted to one line per preset
+// under a new header, which tells readers in other processes to start over.
+class UsageJournal
+{
+public:
+    explicit UsageJournal(const QString &filePath);
+    ~UsageJournal();
+
+    QString filePath() const;
+    PresetUsage usage(const QString &presetId) const;
+
+    // Reads records written since the last sync, returns presets whose usage changed
+    QStringList sync();
+
+    // Counts a use of presetId and appends it unless another process holds the
+    // lock, returns presets whose usage changed (including records from other
+    // processes picked up on the way)
+    QStringList record(const QString &presetId, const QDateTime &when, qint64 applyDuration);
+
+    // Records that could not be appended yet, flush() retries them
+    bool hasPendingRecords() const;
+    // Appends pending records if the lock is free, otherwise only syncs
+    QStringList flush();
+
+    // Presets that still exist, compaction drops usage of any other id
+    void setPresetIds(const QSet<QString> &presetIds);
+
+private:
+    QStringList resync(const QByteArray &header, const QByteArray &records);
+    QStringList applyRecords(const QByteArray &records);
+    void compact();
+
+    QString m_filePath;
+    QByteArray m_header;
+    qint64 m_offset = 0;
+    QHash<QString, PresetUsage> m_usage;
+    // Formatted lines waiting for the lock, already included in m_usage
+    QByteArray m_pendingRecords;
+    std::optional<QSet<QString>> m_presetIds;
+};
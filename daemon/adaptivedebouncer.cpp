@@ -0,0 +1,92 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "adaptivedebouncer.h"
+#include "kdisplaypresets_daemon_debug.h"
+
+#include <QTimer>
+
+// The fixed delay used before the window became adaptive
+static constexpr int s_defaultMaximumInterval = 500;
+static constexpr int s_minimumInterval = 50;
+// Weight of the newest burst in the gap estimate
+static constexpr qreal s_smoothing = 0.25;
+// Headroom over the estimated gap so a typical burst is not split
+static constexpr qreal s_gapHeadroom = 2.0;
+
+AdaptiveDebouncer::AdaptiveDebouncer(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+    , m_maximumInterval(s_defaultMaximumInterval)
+    , m_gapEstimate(s_defaultMaximumInterval / s_gapHeadroom / 2)
+{
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(interval());
+    connect(m_timer, &QTimer::timeout, this, &AdaptiveDebouncer::settle);
+}
+
+void AdaptiveDebouncer::setMaximumInterval(int maximumInterval)
+{
+    m_maximumInterval = qMax(0, maximumInterval);
+    m_timer->setInterval(interval());
+}
+
+int AdaptiveDebouncer::maximumInterval() const
+{
+    return m_maximumInterval;
+}
+
+int AdaptiveDebouncer::interval() const
+{
+    if (m_maximumInterval == 0) {
+        return 0;
+    }
+    return qBound(qMin(s_minimumInterval, m_maximumInterval), qRound(m_gapEstimate * s_gapHeadroom), m_maximumInterval);
+}
+
+qint64 AdaptiveDebouncer::burstElapsed() const
+{
+    return m_burstTimer.isValid() ? m_burstTimer.elapsed() : 0;
+}
+
+void AdaptiveDebouncer::trigger()
+{
+    if (m_maximumInterval == 0) {
+        m_burstTimer.start();
+        Q_EMIT burstStarted();
+        Q_EMIT burstSettled(false);
+        return;
+    }
+
+    if (!m_timer->isActive()) {
+        // Leading edge
+        m_burstTimer.start();
+        m_lastEventAt = 0;
+        m_longestGap = 0;
+        m_eventCount = 1;
+        m_timer->start();
+        Q_EMIT burstStarted();
+        return;
+    }
+
+    const qint64 now = m_burstTimer.elapsed();
+    m_longestGap = qMax(m_longestGap, now - m_lastEventAt);
+    m_lastEventAt = now;
+    ++m_eventCount;
+    m_timer->start();
+}
+
+void AdaptiveDebouncer::settle()
+{
+    // A lone event pulls the window down, a spread out burst pushes it up
+    m_gapEstimate += s_smoothing * (m_longestGap - m_gapEstimate);
+    m_timer->setInterval(interval());
+
+    qCDebug(KDISPLAYPRESETS_DAEMON) << "Config burst of" << m_eventCount << "events over" << m_lastEventAt << "ms, longest gap" << m_longestGap
+                                    << "ms, debounce window now" << interval() << "ms";
+
+    Q_EMIT burstSettled(m_eventCount > 1);
+}
@@ -0,0 +1,51 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+
+class QTimer;
+
+// Debounce for bursts of screen configuration events. The first event of a
+// burst is reported right away, the end of the burst once no event arrived
+// for the current window. The window follows the gaps seen inside past
+// bursts, bounded by the configured maximum.
+class AdaptiveDebouncer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AdaptiveDebouncer(QObject *parent = nullptr);
+
+    void trigger();
+
+    // 0 disables debouncing, every event is reported as its own burst
+    void setMaximumInterval(int maximumInterval);
+    int maximumInterval() const;
+    int interval() const;
+
+    // Time since the first event of the current or last burst
+    qint64 burstElapsed() const;
+
+Q_SIGNALS:
+    void burstStarted();
+    // moreEvents is false when the burst was just the event already reported
+    void burstSettled(bool moreEvents);
+
+private:
+    void settle();
+
+    QTimer *m_timer = nullptr;
+    QElapsedTimer m_burstTimer;
+    qint64 m_lastEventAt = 0;
+    qint64 m_longestGap = 0;
+    int m_eventCount = 0;
+
+    int m_maximumInterval;
+    qreal m_gapEstimate;
+};
@@ -0,0 +1,175 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "applyplan.h"
+#include "kdisplaypresets_daemon_debug.h"
+
+#include <KScreen/Mode>
+#include <KScreen/Output>
+
+#include <QHash>
+
+// Identical monitors share a hash, so one hash can stand for several outputs
+static QHash<QString, QList<PresetOutputSpec>> buildPresetOutputsMap(const QList<PresetOutputSpec> &presetOutputs)
+{
+    QHash<QString, QList<PresetOutputSpec>> outputsMap;
+    for (const PresetOutputSpec &presetOutput : presetOutputs) {
+        if (!presetOutput.id.isEmpty()) {
+            outputsMap[presetOutput.id].append(presetOutput);
+        }
+    }
+    return outputsMap;
+}
+
+// The entry saved for this connector, otherwise one whose connector no output
+// with the same hash uses now, as the monitors were replugged
+static const PresetOutputSpec &matchPresetOutput(const KScreen::OutputPtr &output,
+                                                 const QList<PresetOutputSpec> &candidates,
+                                                 const QStringList &connectorsOfHash)
+{
+    for (const PresetOutputSpec &candidate : candidates) {
+        if (candidate.name == output->name()) {
+            return candidate;
+        }
+    }
+    for (const PresetOutputSpec &candidate : candidates) {
+        if (!connectorsOfHash.contains(candidate.name)) {
+            return candidate;
+        }
+    }
+    return candidates.first();
+}
+
+static QString resolveModeId(const KScreen::OutputPtr &output, const PresetOutputSpec &presetOutput)
+{
+    if (!presetOutput.modeId.isEmpty() && output->modes().contains(presetOutput.modeId)) {
+        return presetOutput.modeId;
+    }
+
+    // Mode ids are backend specific and may change, fall back to size and refresh rate
+    for (const KScreen::ModePtr &mode : output->modes()) {
+        if (mode->size() == presetOutput.modeSize && qAbs(mode->refreshRate() - presetOutput.refreshRate) <= 0.1) {
+            return mode->id();
+        }
+    }
+
+    qCWarning(KDISPLAYPRESETS_DAEMON) << "No mode" << presetOutput.modeSize << "@" << presetOutput.refreshRate << "on output" << output->name()
+                                      << "- keeping the current mode";
+    return QString();
+}
+
+// Sets only the properties that differ, returns whether the output changed at all
+static bool applyPresetToOutput(const KScreen::OutputPtr &output, const PresetOutputSpec &presetOutput, const KScreen::ConfigPtr &config)
+{
+    bool changed = false;
+
+    // Apply basic output settings - enable/disable first
+    if (output->isEnabled() != presetOutput.enabled) {
+        output->setEnabled(presetOutput.enabled);
+        changed = true;
+    }
+
+    if (!presetOutput.enabled) {
+        return changed;
+    }
+
+    // Apply mode, a modeset is the expensive part of an apply
+    const QString modeId = resolveModeId(output, presetOutput);
+    if (!modeId.isEmpty() && output->currentModeId() != modeId) {
+        qCDebug(KDISPLAYPRESETS_DAEMON) << "Mode change on" << output->name() << output->currentModeId() << "->" << modeId;
+        output->setCurrentModeId(modeId);
+        changed = true;
+    }
+
+    // Apply scale, with the same tolerance the current-state check uses
+    if (qAbs(output->scale() - presetOutput.scale) > 0.01) {
+        output->setScale(presetOutput.scale);
+        changed = true;
+    }
+
+    // Apply rotation
+    if (output->rotation() != presetOutput.rotation) {
+        output->setRotation(presetOutput.rotation);
+        changed = true;
+    }
+
+    // Apply position
+    if (output->pos() != presetOutput.pos) {
+        output->setPos(presetOutput.pos);
+        changed = true;
+    }
+
+    // Apply priority (after enabled state is set to ensure correct ordering)
+    if (output->priority() != presetOutput.priority) {
+        config->setOutputPriority(output, presetOutput.priority);
+        changed = true;
+    }
+
+    return changed;
+}
+
+ApplyPlan ApplyPlan::build(const QString &presetId, const PresetConfiguration &configuration, const KScreen::ConfigPtr &liveConfig)
+{
+    ApplyPlan plan;
+    if (!liveConfig || configuration.isEmpty()) {
+        return plan;
+    }
+
+    // Work on a copy, the live config must keep mirroring the backend
+    const KScreen::ConfigPtr config = liveConfig->clone();
+    const QHash<QString, QList<PresetOutputSpec>> presetOutputsMap = buildPresetOutputsMap(configuration.outputs());
+
+    const auto outputs = config->outputs();
+    // hashMd5() is computed from EDID on every call
+    QHash<int, QString> outputIds;
+    QHash<QString, QStringList> connectorsByHash;
+    for (const auto &output : outputs) {
+        const QString outputId = output->hashMd5();
+        outputIds.insert(output->id(), outputId);
+        connectorsByHash[outputId].append(output->name());
+    }
+
+    for (const auto &output : outputs) {
+        const QString outputId = outputIds.value(output->id());
+        const auto it = presetOutputsMap.constFind(outputId);
+        if (it != presetOutputsMap.constEnd()) {
+            // Output is in preset - apply its configuration
+            const PresetOutputSpec &presetOutput = matchPresetOutput(output, it.value(), connectorsByHash.value(outputId));
+            if (applyPresetToOutput(output, presetOutput, config)) {
+                ++plan.m_changedOutputs;
+            }
+        } else if (output->isConnected() && output->isEnabled()) {
+            // Output is NOT in preset - disable it
+            output->setEnabled(false);
+            ++plan.m_changedOutputs;
+        }
+    }
+
+    qCDebug(KDISPLAYPRESETS_DAEMON) << "Apply plan for" << presetId << "changes" << plan.m_changedOutputs << "outputs";
+    plan.m_presetId = presetId;
+    plan.m_config = config;
+    return plan;
+}
+
+bool ApplyPlan::isValid() const
+{
+    return !m_config.isNull();
+}
+
+QString ApplyPlan::presetId() const
+{
+    return m_presetId;
+}
+
+KScreen::ConfigPtr ApplyPlan::config() const
+{
+    return m_config;
+}
+
+bool ApplyPlan::isNoop() const
+{
+    return m_changedOutputs == 0;
+}
@@ -0,0 +1,35 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "common/presetconfiguration.h"
+
+#include <KScreen/Config>
+
+#include <QString>
+
+// Target screen configuration for one preset, resolved against the live config
+// ahead of time so applying the preset is a single SetConfigOperation. Only
+// properties that differ from the live config are touched.
+class ApplyPlan
+{
+public:
+    ApplyPlan() = default;
+
+    static ApplyPlan build(const QString &presetId, const PresetConfiguration &configuration, const KScreen::ConfigPtr &liveConfig);
+
+    bool isValid() const;
+    QString presetId() const;
+    KScreen::ConfigPtr config() const;
+    // True when the live config already matches the preset
+    bool isNoop() const;
+
+private:
+    QString m_presetId;
+    KScreen::ConfigPtr m_config;
+    int m_changedOutputs = 0;
+};
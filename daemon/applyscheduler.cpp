@@ -0,0 +1,165 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "applyscheduler.h"
+#include "kdisplaypresets_daemon_debug.h"
+
+#include <KLocalizedString>
+
+#include <KScreen/SetConfigOperation>
+
+#include <utility>
+
+ApplyScheduler::ApplyScheduler(PlanBuilder planBuilder, QObject *parent)
+    : QObject(parent)
+    , m_planBuilder(std::move(planBuilder))
+{
+}
+
+uint ApplyScheduler::nextRequestId()
+{
+    // 0 marks an empty slot
+    if (++m_lastRequestId == 0) {
+        ++m_lastRequestId;
+    }
+    return m_lastRequestId;
+}
+
+uint ApplyScheduler::schedule(const QString &presetId)
+{
+    Request request;
+    request.id = nextRequestId();
+    request.presetId = presetId;
+    request.timer.start();
+
+    // Latest wins, whatever was waiting is never submitted
+    if (m_pending.id != 0) {
+        qCDebug(KDISPLAYPRESETS_DAEMON) << "Apply request" << m_pending.id << "for" << m_pending.presetId << "superseded by" << request.id;
+        finish(m_pending, Superseded);
+    }
+    m_pending = request;
+
+    dispatchNext();
+    return request.id;
+}
+
+uint ApplyScheduler::reject(const QString &presetId, const QString &errorString)
+{
+    Request request;
+    request.id = nextRequestId();
+    request.presetId = presetId;
+    request.timer.start();
+
+    finish(request, Failed, errorString);
+    return request.id;
+}
+
+void ApplyScheduler::setPaused(bool paused)
+{
+    m_paused = paused;
+    dispatchNext();
+}
+
+void ApplyScheduler::cancelPending(const QString &errorString)
+{
+    if (m_pending.id != 0) {
+        finish(std::exchange(m_pending, Request()), Failed, errorString);
+    }
+}
+
+void ApplyScheduler::liveConfigUpdated()
+{
+    ++m_liveGeneration;
+    m_appliedConfig.reset();
+}
+
+void ApplyScheduler::dispatchNext()
+{
+    if (m_paused || m_inFlight.id != 0 || m_pending.id == 0) {
+        return;
+    }
+
+    const Request request = std::exchange(m_pending, Request());
+
+    QString errorString;
+    const ApplyPlan plan = m_planBuilder(request.presetId, m_appliedConfig, &errorString);
+    if (!plan.isValid()) {
+        finish(request, Failed, errorString);
+        return;
+    }
+
+    // Repeated presses of an active preset must not trigger a modeset
+    if (plan.isNoop()) {
+        qCDebug(KDISPLAYPRESETS_DAEMON) << "Preset" << request.presetId << "already matches the screen configuration, nothing to apply";
+        finish(request, Unchanged);
+        return;
+    }
+
+    m_inFlight = request;
+    m_inFlightConfig = plan.config();
+    m_inFlightGeneration = m_liveGeneration;
+
+    auto *setConfigOp = new KScreen::SetConfigOperation(m_inFlightConfig);
+    connect(setConfigOp, &KScreen::SetConfigOperation::finished, this, &ApplyScheduler::setConfigFinished);
+}
+
+void ApplyScheduler::setConfigFinished(KScreen::ConfigOperation *op)
+{
+    const Request request = std::exchange(m_inFlight, Request());
+    const KScreen::ConfigPtr config = std::exchange(m_inFlightConfig, KScreen::ConfigPtr());
+    op->deleteLater();
+
+    if (op->hasError()) {
+        // Leave m_appliedConfig alone, the backend did not take this config
+        finish(request, Failed, i18n("Failed to apply preset: %1", op->errorString()));
+        Q_EMIT setConfigFailed();
+    } else {
+        // The config monitor may report the change later than this. If it
+        // already reported something since the submit, the live config is
+        // at least as new as ours and must stay the base for later plans.
+        if (m_liveGeneration == m_inFlightGeneration) {
+            m_appliedConfig = config;
+        }
+        finish(request, Applied);
+    }
+
+    dispatchNext();
+}
+
+void ApplyScheduler::finish(const Request &request, Outcome outcome, const QString &errorString)
+{
+    const qint64 elapsed = request.timer.elapsed();
+    if (outcome == Failed) {
+        qCWarning(KDISPLAYPRESETS_DAEMON) << "Apply request" << request.id << "for" << request.presetId << "failed:" << errorString;
+    } else {
+        qCDebug(KDISPLAYPRESETS_DAEMON) << "Apply request" << request.id << "for" << request.presetId << outcomeName(outcome) << "after" << elapsed << "ms";
+    }
+
+    // Queued, so callers get their request id before hearing how it ended
+    QMetaObject::invokeMethod(
+        this,
+        [this, request, outcome, errorString, elapsed] {
+            Q_EMIT requestFinished(request.id, request.presetId, outcome, errorString, elapsed);
+        },
+        Qt::QueuedConnection);
+}
+
+QString ApplyScheduler::outcomeName(Outcome outcome)
+{
+    switch (outcome) {
+    case Applied:
+        return QStringLiteral("applied");
+    case Superseded:
+        return QStringLiteral("superseded");
+    case Failed:
+        return QStringLiteral("failed");
+    case Unchanged:
+        return QStringLiteral("unchanged");
+    }
+    return QString();
+}
+
+#include "moc_applyscheduler.cpp"
@@ -0,0 +1,90 @@
+/*
+    SPDX-FileCopyrightText: 2025 Jerzy Kołosowski <jerzy@kolosowscy.pl>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "applyplan.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+
+#include <functional>
+
+namespace KScreen
+{
+class ConfigOperation;
+}
+
+// Serializes preset applies: at most one SetConfigOperation is in flight and a
+// newer request replaces the one waiting behind it, so repeated shortcut
+// presses end in the last preset without modesetting through the others.
+class ApplyScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Outcome {
+        Applied,
+        Superseded,
+        Failed,
+        Unchanged,
+    };
+    Q_ENUM(Outcome)
+
+    // Resolves a preset at dispatch time. baseConfig is the config submitted by
+    // the previous apply while the live config has not caught up yet, or null.
+    using PlanBuilder = std::function<ApplyPlan(const QString &presetId, const KScreen::ConfigPtr &baseConfig, QString *errorString)>;
+
+    explicit ApplyScheduler(PlanBuilder planBuilder, QObject *parent = nullptr);
+
+    // Returns the request id reported back with requestFinished()
+    uint schedule(const QString &presetId);
+
+    // Rejects a request without queueing it, e.g. for an unknown preset
+    uint reject(const QString &presetId, const QString &errorString);
+
+    // While paused requests are queued but not dispatched
+    void setPaused(bool paused);
+    // Fails the waiting request, e.g. when no screen configuration can be obtained
+    void cancelPending(const QString &errorString);
+
+    // The live config reflects every finished apply again
+    void liveConfigUpdated();
+
+    static QString outcomeName(Outcome outcome);
+
+Q_SIGNALS:
+    void requestFinished(uint requestId, const QString &presetId, ApplyScheduler::Outcome outcome, const QString &errorString, qint64 elapsed);
+    void setConfigFailed();
+
+private:
+    struct Request {
+        uint id = 0;
+        QString presetId;
+        QElapsedTimer timer;
+    };
+
+    uint nextRequestId();
+    void dispatchNext();
+    void finish(const Request &request, Outcome outcome, const QString &errorString = QString());
+    void setConfigFinished(KScreen::ConfigOperation *op);
+
+    PlanBuilder m_planBuilder;
+    uint m_lastRequestId = 0;
+    bool m_paused = false;
+
+    Request m_inFlight;
+    KScreen::ConfigPtr m_inFlightConfig;
+    // m_liveGeneration when the in-flight request was submitted
+    quint64 m_inFlightGeneration = 0;
+    Request m_pending;
+
+    // Config the backend should have after the last apply, until the live config is updated
+    KScreen::ConfigPtr m_appliedConfig;
+    // Counts liveConfigUpdated() calls
+    quint64 m_liveGeneration = 0;
+};
@@ -14,7 +14,12 @@
 #include <QDBusConnection>
 #include <QGuiApplication>
 
-QString parseCommandLineArguments(QGuiApplication &app)
+struct CommandLineOptions {
+    QString presetsFile;
+    int debounceInterval = -1;
+};
+
+CommandLineOptions parseCommandLineArguments(QGuiApplication &app)
 {
     QCommandLineParser parser;
     parser.setApplicationDescription(i18n("KDE Display Presets Service"));
@@ -24,15 +29,30 @@ QString parseCommandLineArguments(QGuiApplication &app)
     QCommandLineOption presetsFileOption(QStringList() << "p" << "presets-file", i18n("Use custom presets file path instead of default location"), "file");
     parser.addOption(presetsFileOption);
 
+    QCommandLineOption debounceOption(QStringList() << "debounce-interval",
+                                      i18n("Longest time in milliseconds to wait for a burst of display changes to settle, 0 to disable"),
+                                      "ms");
+    parser.addOption(debounceOption);
+
     parser.process(app);
 
-    const QString customFilePath = parser.isSet(presetsFileOption) ? parser.value(presetsFileOption) : QString();
+    CommandLineOptions options;
+    options.presetsFile = parser.isSet(presetsFileOption) ? parser.value(presetsFileOption) : QString();
 
-    if (!customFilePath.isEmpty()) {
-        qCDebug(KDISPLAYPRESETS_DAEMON) << "Custom presets file specified:" << customFilePath;
+    if (!options.presetsFile.isEmpty()) {
+        qCDebug(KDISPLAYPRESETS_DAEMON) << "Custom presets file specified:" << options.presetsFile;
     }
 
-    return customFilePath;
+    if (parser.isSet(debounceOption)) {
+        bool ok = false;
+        options.debounceInterval = parser.value(debounceOption).toInt(&ok);
+        if (!ok || options.debounceInterval < 0) {
+            qCWarning(KDISPLAYPRESETS_DAEMON) << "Ignoring invalid debounce interval" << parser.value(debounceOption);
+            options.debounceInterval = -1;
+        }
+    }
+
+    return options;
 }
 
 int main(int argc, char *argv[])
@@ -41,7 +61,7 @@ int main(int argc, char *argv[])
     app.setApplicationName(QStringLiteral("kdisplaypresets_daemon"));
     app.setApplicationVersion(QStringLiteral(KDISPLAYPRESETS_VERSION_STRING));
 
-    const QString customFilePath = parseCommandLineArguments(app);
+    const CommandLineOptions options = parseCommandLineArguments(app);
 
     if (!QDBusConnection::sessionBus().isConnected()) {
         qCCritical(KDISPLAYPRESETS_DAEMON) << "Cannot connect to the D-Bus session bus."
@@ -49,7 +69,10 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    PresetsService service(nullptr, customFilePath);
+    PresetsService service(nullptr, options.presetsFile);
+    if (options.debounceInterval >= 0) {
+        service.setDebounceInterval(options.debounceInterval);
+    }
 
     if (!service.init()) {
         qCCritical(KDISPLAYPRESETS_DAEMON) << "Failed to initialize PresetsService";
@@ -5,6 +5,7 @@
 */
 
 #include "presetsservice.h"
+#include "adaptivedebouncer.h"
 #include "kdisplaypresets_daemon_debug.h"
 
 #include <KLocalizedString>
@@ -14,7 +15,6 @@
 #include <KScreen/GetConfigOperation>
 #include <KScreen/Mode>
 #include <KScreen/Output>
-#include <KScreen/SetConfigOperation>
 
 #include <KGlobalAccel>
 
@@ -22,6 +22,13 @@
 #include <QDBusMetaType>
 #include <QTimer>
 
+#include <utility>
+
+// Milliseconds model and status changes are collected for before one D-Bus
+// signal goes out. Kept below the debouncer's 50 ms minimum so the status of a
+// burst's leading edge still reaches clients in the tens of milliseconds.
+static constexpr int s_signalCoalesceInterval = 20;
+
 PresetsService::PresetsService(QObject *parent, const QString &customPresetsFile)
     : QObject(parent)
 {
@@ -30,15 +37,34 @@ PresetsService::PresetsService(QObject *parent, const QString &customPresetsFile
     m_configMonitor = KScreen::ConfigMonitor::instance();
     connect(m_configMonitor, &KScreen::ConfigMonitor::configurationChanged, this, &PresetsService::configChanged);
 
-    // Timer to debounce rapid config changes
-    m_configUpdateTimer = new QTimer(this);
-    m_configUpdateTimer->setSingleShot(true);
-    m_configUpdateTimer->setInterval(500); // 500ms delay
-    connect(m_configUpdateTimer, &QTimer::timeout, this, &PresetsService::updatePresetScreenConfiguration);
-
-    // Initialize shortcuts and emit D-Bus signal when presets change
-    connect(m_presets, &Presets::presetsChanged, this, &PresetsService::initShortcuts);
-    connect(m_presets, &Presets::presetsChanged, this, &PresetsService::onPresetsModelChanged);
+    // Debounce bursts of config changes, reacting to the first one right away
+    m_configDebouncer = new AdaptiveDebouncer(this);
+    connect(m_configDebouncer, &AdaptiveDebouncer::burstStarted, this, &PresetsService::onConfigBurstStarted);
+    connect(m_configDebouncer, &AdaptiveDebouncer::burstSettled, this, &PresetsService::onConfigBurstSettled);
+
+    // Applies wait for the first screen configuration
+    m_applyScheduler = new ApplyScheduler(
+        [this](const QString &presetId, const KScreen::ConfigPtr &baseConfig, QString *errorString) {
+            return buildApplyPlan(presetId, baseConfig, errorString);
+        },
+        this);
+    m_applyScheduler->setPaused(true);
+    connect(m_applyScheduler, &ApplyScheduler::requestFinished, this, &PresetsService::onApplyRequestFinished);
+    // Our snapshot may have drifted from the backend, start over from a fresh one
+    connect(m_applyScheduler, &ApplyScheduler::setConfigFailed, this, &PresetsService::fetchScreenConfiguration);
+
+    // Keep global shortcuts in step with the presets and emit D-Bus signals when they change
+    connect(m_presets, &Presets::presetsChanged, this, &PresetsService::reconcileShortcuts);
+    connect(m_presets, &Presets::presetsModified, this, &PresetsService::onPresetsModelChanged);
+    connect(m_presets, &Presets::presetStatusChanged, this, &PresetsService::onPresetStatusChanged);
+    // Presets loaded at startup are not news to anyone
+    m_signalledRevision = m_presets->revision();
+
+    // One D-Bus signal per burst of model and status changes
+    m_signalTimer = new QTimer(this);
+    m_signalTimer->setSingleShot(true);
+    m_signalTimer->setInterval(s_signalCoalesceInterval);
+    connect(m_signalTimer, &QTimer::timeout, this, &PresetsService::flushPendingSignals);
 }
 
 PresetsService::~PresetsService() = default;
@@ -50,10 +76,12 @@ bool PresetsService::init()
     // Register D-Bus meta types for complex data types
     qDBusRegisterMetaType<QVariantList>();
     qDBusRegisterMetaType<QVariantMap>();
+    registerPresetsDBusTypes();
 
     if (!QDBusConnection::sessionBus().registerObject(QStringLiteral("/"),
                                                       this,
-                                                      QDBusConnection::ExportScriptableSlots | QDBusConnection::ExportScriptableSignals)) {
+                                                      QDBusConnection::ExportScriptableSlots | QDBusConnection::ExportScriptableSignals
+                                                          | QDBusConnection::ExportScriptableProperties)) {
         qCCritical(KDISPLAYPRESETS_DAEMON) << "Failed to register D-Bus object";
         return false;
     }
@@ -63,11 +91,11 @@ bool PresetsService::init()
         return false;
     }
 
-    // Initialize cache with current presets
-    m_previousPresets = getPresets();
+    // Presets loaded before the model was connected
+    reconcileShortcuts();
 
-    // Get initial screen configuration
-    updatePresetScreenConfiguration();
+    // Get initial screen configuration, the config monitor keeps it current afterwards
+    fetchScreenConfiguration();
 
     qCDebug(KDISPLAYPRESETS_DAEMON) << "PresetsService initialized successfully";
     return true;
@@ -75,132 +103,196 @@ bool PresetsService::init()
 
 void PresetsService::configChanged()
 {
-    // Restart timer on each config change to debounce rapid changes
-    m_configUpdateTimer->start();
+    // Plans were resolved against the previous outputs, build on demand until refreshed
+    m_applyPlans.clear();
+    // The monitor has updated m_config in place
+    m_applyScheduler->liveConfigUpdated();
+
+    m_configDebouncer->trigger();
+}
+
+void PresetsService::onConfigBurstStarted()
+{
+    // Status only, so clients learn about a hotplug without waiting for the burst to end
+    if (updatePresetScreenConfiguration()) {
+        recordUpdateLatency();
+    }
+}
+
+void PresetsService::onConfigBurstSettled(bool moreEvents)
+{
+    if (moreEvents) {
+        if (!updatePresetScreenConfiguration()) {
+            return;
+        }
+        recordUpdateLatency();
+    }
+
+    rebuildApplyPlans();
 }
 
-void PresetsService::updatePresetScreenConfiguration()
+bool PresetsService::updatePresetScreenConfiguration()
 {
+    // The monitor keeps m_config up to date, only a lost or invalid config needs the backend
+    if (!m_config || !m_config->isValid()) {
+        fetchScreenConfiguration();
+        return false;
+    }
+
     qCDebug(KDISPLAYPRESETS_DAEMON) << "Updating preset screen configuration";
+    // Presets whose status flipped are reported through presetStatusChanged
+    m_presets->setScreenConfiguration(m_config);
+    return true;
+}
+
+void PresetsService::recordUpdateLatency()
+{
+    m_lastUpdateLatency = m_configDebouncer->burstElapsed();
+    qCDebug(KDISPLAYPRESETS_DAEMON) << "Preset status updated" << m_lastUpdateLatency << "ms after the first config change";
+}
+
+void PresetsService::setDebounceInterval(int interval)
+{
+    m_configDebouncer->setMaximumInterval(interval);
+}
+
+int PresetsService::debounceInterval() const
+{
+    return m_configDebouncer->interval();
+}
+
+qint64 PresetsService::lastUpdateLatency() const
+{
+    return m_lastUpdateLatency;
+}
+
+void PresetsService::fetchScreenConfiguration()
+{
+    if (m_fetchingConfig) {
+        return;
+    }
 
-    // Use KCM-style GetConfigOperation approach
+    qCDebug(KDISPLAYPRESETS_DAEMON) << "Fetching screen configuration from backend";
+    m_fetchingConfig = true;
     connect(new KScreen::GetConfigOperation(), &KScreen::GetConfigOperation::finished, this, &PresetsService::configReady);
 }
 
 void PresetsService::configReady(KScreen::ConfigOperation *op)
 {
     qCDebug(KDISPLAYPRESETS_DAEMON) << "Config operation finished";
+    m_fetchingConfig = false;
+    op->deleteLater();
 
     if (op->hasError()) {
         qCWarning(KDISPLAYPRESETS_DAEMON) << "GetConfigOperation failed:" << op->errorString();
-        op->deleteLater();
+        m_applyScheduler->cancelPending(i18n("Failed to get current config: %1", op->errorString()));
         return;
     }
 
     auto config = qobject_cast<KScreen::GetConfigOperation *>(op)->config();
     qCDebug(KDISPLAYPRESETS_DAEMON) << "GetConfigOperation successful, outputs count:" << (config ? config->outputs().count() : 0);
 
-    if (config) {
-        // Add config to monitor like KDED and KCM do
-        KScreen::ConfigMonitor::instance()->addConfig(config);
-
-        m_presets->setScreenConfiguration(config);
-        emitPresetsChanged();
-        qCDebug(KDISPLAYPRESETS_DAEMON) << "Screen configuration updated successfully";
-    } else {
+    if (!config) {
         qCWarning(KDISPLAYPRESETS_DAEMON) << "Failed to update screen configuration - missing config";
+        m_applyScheduler->cancelPending(i18n("Invalid config received"));
+        return;
     }
 
-    op->deleteLater();
+    // The monitor updates this one config in place from now on
+    if (m_config) {
+        m_configMonitor->removeConfig(m_config);
+    }
+    m_config = config;
+    m_configMonitor->addConfig(m_config);
+
+    m_presets->setScreenConfiguration(m_config);
+    rebuildApplyPlans();
+    qCDebug(KDISPLAYPRESETS_DAEMON) << "Screen configuration updated successfully";
+
+    m_applyScheduler->liveConfigUpdated();
+    m_applyScheduler->setPaused(false);
 }
 
-void PresetsService::applyPreset(const QString &presetId)
+uint PresetsService::applyPreset(const QString &presetId)
 {
     qCDebug(KDISPLAYPRESETS_DAEMON) << "Applying preset:" << presetId;
 
+    if (!m_presets->preset(presetId)) {
+        return m_applyScheduler->reject(presetId, i18n("Preset data not found: %1", presetId));
+    }
+
+    if (!m_config) {
+        // Still starting up or recovering, the scheduler waits until the configuration arrives
+        fetchScreenConfiguration();
+    }
+
+    return m_applyScheduler->schedule(presetId);
+}
+
+ApplyPlan PresetsService::buildApplyPlan(const QString &presetId, const KScreen::ConfigPtr &baseConfig, QString *errorString)
+{
     if (!m_presets->isPresetAvailable(presetId)) {
-        const QString error = i18n("Preset not available: %1", presetId);
-        qCWarning(KDISPLAYPRESETS_DAEMON) << error;
-        Q_EMIT errorOccurred(error);
-        return;
+        *errorString = i18n("Preset not available: %1", presetId);
+        return ApplyPlan();
     }
 
     // Find preset data
-    QVariantMap presetData;
-    for (int i = 0; i < m_presets->rowCount(); ++i) {
-        const QModelIndex idx = m_presets->index(i, 0);
-        if (m_presets->data(idx, Presets::IdRole).toString() == presetId) {
-            presetData = m_presets->data(idx, Presets::ConfigurationRole).toMap();
-            break;
-        }
+    const DisplayPreset *preset = m_presets->preset(presetId);
+
+    if (!preset || preset->configuration.isEmpty()) {
+        *errorString = i18n("Preset data not found: %1", presetId);
+        return ApplyPlan();
     }
 
-    if (presetData.isEmpty()) {
-        const QString error = i18n("Preset data not found: %1", presetId);
-        qCWarning(KDISPLAYPRESETS_DAEMON) << error;
-        Q_EMIT errorOccurred(error);
-        return;
+    // Right after another apply, resolve against what that apply submitted
+    if (baseConfig) {
+        return ApplyPlan::build(presetId, preset->configuration, baseConfig);
     }
 
-    // Get current config and apply preset
-    auto *getConfigOp = new KScreen::GetConfigOperation();
-    connect(getConfigOp, &KScreen::GetConfigOperation::finished, this, [this, presetId, presetData](KScreen::ConfigOperation *op) {
-        if (op->hasError()) {
-            const QString error = i18n("Failed to get current config: %1", op->errorString());
-            qCWarning(KDISPLAYPRESETS_DAEMON) << error;
-            Q_EMIT errorOccurred(error);
-            op->deleteLater();
-            return;
-        }
+    // Normally prepared when the screen configuration changed, so this only submits it
+    ApplyPlan plan = m_applyPlans.value(presetId);
+    if (!plan.isValid()) {
+        qCDebug(KDISPLAYPRESETS_DAEMON) << "No prepared apply plan for" << presetId << "- building it now";
+        plan = ApplyPlan::build(presetId, preset->configuration, m_config);
+        m_applyPlans.insert(presetId, plan);
+    }
 
-        auto config = qobject_cast<KScreen::GetConfigOperation *>(op)->config();
-        if (!config) {
-            const QString error = i18n("Invalid config received");
-            qCWarning(KDISPLAYPRESETS_DAEMON) << error;
-            Q_EMIT errorOccurred(error);
-            op->deleteLater();
-            return;
-        }
+    // A submitted plan's config belongs to the operation now
+    if (!plan.isNoop()) {
+        m_applyPlans.remove(presetId);
+    }
+    return plan;
+}
 
-        // Apply preset configuration
-        const QVariantList outputsList = presetData.value(QStringLiteral("outputs")).toList();
-        const QHash<QString, QVariantMap> presetOutputsMap = buildPresetOutputsMap(outputsList);
-
-        const auto outputs = config->outputs();
-        for (const auto &output : outputs) {
-            const QString outputId = output->hashMd5();
-            if (presetOutputsMap.contains(outputId)) {
-                // Output is in preset - apply its configuration
-                applyPresetToOutput(output, presetOutputsMap[outputId], config);
-                qCDebug(KDISPLAYPRESETS_DAEMON) << "Applied preset settings to output:" << outputId
-                                                << "(port:" << output->name() << ")";
-            } else {
-                // Output is NOT in preset - disable it
-                if (output->isConnected()) {
-                    output->setEnabled(false);
-                    qCDebug(KDISPLAYPRESETS_DAEMON) << "Disabled output not in preset:" << outputId
-                                                    << "(port:" << output->name() << ")";
-                }
-            }
-        }
+void PresetsService::onApplyRequestFinished(uint requestId, const QString &presetId, ApplyScheduler::Outcome outcome, const QString &errorString, qint64 elapsed)
+{
+    if (outcome == ApplyScheduler::Applied) {
+        // Record the use in the usage journal
+        m_presets->updateLastUsed(presetId, elapsed);
+        qCDebug(KDISPLAYPRESETS_DAEMON) << "Preset applied successfully:" << presetId;
+    } else if (outcome == ApplyScheduler::Failed) {
+        Q_EMIT errorOccurred(errorString);
+    }
 
-        // Apply the configuration
-        auto *setConfigOp = new KScreen::SetConfigOperation(config);
-        connect(setConfigOp, &KScreen::SetConfigOperation::finished, this, [this, presetId](KScreen::ConfigOperation *setOp) {
-            if (setOp->hasError()) {
-                const QString error = i18n("Failed to apply preset: %1", setOp->errorString());
-                qCWarning(KDISPLAYPRESETS_DAEMON) << error;
-                Q_EMIT errorOccurred(error);
-            } else {
-                // Update last used timestamp
-                m_presets->updateLastUsed(presetId);
-                qCDebug(KDISPLAYPRESETS_DAEMON) << "Preset applied successfully:" << presetId;
-            }
-            setOp->deleteLater();
-        });
-
-        op->deleteLater();
-    });
+    Q_EMIT presetApplied(requestId, presetId, ApplyScheduler::outcomeName(outcome));
+}
+
+PresetSummary PresetsService::buildPresetSummary(const DisplayPreset &preset) const
+{
+    PresetSummary summary;
+    summary.presetId = preset.id;
+    summary.name = preset.name;
+    summary.description = preset.description;
+    summary.outputCount = preset.outputIds.count();
+    summary.lastUsed = preset.lastUsed.toString(Qt::ISODate);
+    summary.shortcut = preset.shortcut.toString();
+    summary.isAvailable = m_presets->isPresetAvailable(preset.id);
+    summary.isCurrent = m_presets->isPresetCurrent(preset.id);
+    // Changes whenever the configuration does, clients key their cached copy on it
+    // Clients key cached configurations by it, so usage and metadata edits must not move it
+    summary.revision = m_presets->presetConfigurationRevision(preset.id);
+    summary.preview = preset.configuration.previewOutputs();
+    return summary;
 }
 
 QVariantMap PresetsService::buildPresetMap(const QModelIndex &index) const
@@ -230,109 +322,182 @@ QVariantList PresetsService::getPresets()
     return presets;
 }
 
-void PresetsService::emitPresetsChanged(const QStringList &changedPresetIds)
+PresetSummaryList PresetsService::listPresets()
 {
-    QVariantList changedPresets;
-
-    if (changedPresetIds.isEmpty()) {
-        changedPresets = getPresets();
-    } else {
-        for (const QString &presetId : changedPresetIds) {
-            // Find preset in model
-            for (int i = 0; i < m_presets->rowCount(); ++i) {
-                const QModelIndex index = m_presets->index(i, 0);
-                if (m_presets->data(index, Presets::IdRole).toString() == presetId) {
-                    changedPresets.append(buildPresetMap(index));
-                    break;
-                }
-            }
-            // If preset not found (deleted), emit minimal info with deleted flag
-            if (changedPresets.isEmpty() || changedPresets.last().toMap().value(QStringLiteral("presetId")).toString() != presetId) {
-                QVariantMap deletedPreset;
-                deletedPreset[QStringLiteral("presetId")] = presetId;
-                deletedPreset[QStringLiteral("deleted")] = true;
-                changedPresets.append(deletedPreset);
-            }
-        }
+    const QList<DisplayPreset> &presets = m_presets->presets();
+    PresetSummaryList summaries;
+    summaries.reserve(presets.count());
+    for (const DisplayPreset &preset : presets) {
+        summaries.append(buildPresetSummary(preset));
     }
-
-    Q_EMIT presetsChanged(changedPresets);
+    return summaries;
 }
 
-void PresetsService::initShortcuts()
+PresetOutputDataList PresetsService::getPresetConfiguration(const QString &presetId)
 {
-    // Clear existing shortcuts
-    for (auto action : m_shortcutActions) {
-        KGlobalAccel::self()->removeAllShortcuts(action);
-        action->deleteLater();
+    const DisplayPreset *preset = m_presets->preset(presetId);
+    if (!preset) {
+        qCWarning(KDISPLAYPRESETS_DAEMON) << "Configuration requested for unknown preset" << presetId;
+        return PresetOutputDataList();
     }
-    m_shortcutActions.clear();
 
-    // Register shortcuts for all presets
-    for (int i = 0; i < m_presets->rowCount(); ++i) {
-        const QModelIndex idx = m_presets->index(i, 0);
-        const QString presetId = m_presets->data(idx, Presets::IdRole).toString();
-        const QKeySequence shortcut = m_presets->data(idx, Presets::ShortcutRole).value<QKeySequence>();
+    const QList<PresetOutputSpec> &outputs = preset->configuration.outputs();
+    PresetOutputDataList result;
+    result.reserve(outputs.count());
+    for (const PresetOutputSpec &spec : outputs) {
+        PresetOutputData output;
+        output.id = spec.id;
+        output.name = spec.name;
+        output.displayName = spec.displayName;
+        output.vendor = spec.vendor;
+        output.model = spec.model;
+        output.enabled = spec.enabled;
+        output.priority = spec.priority;
+        output.x = spec.pos.x();
+        output.y = spec.pos.y();
+        output.modeId = spec.modeId;
+        output.modeWidth = spec.modeSize.width();
+        output.modeHeight = spec.modeSize.height();
+        output.refreshRate = spec.refreshRate;
+        output.scale = spec.scale;
+        output.rotation = spec.rotation;
+        output.overscan = spec.overscan;
+        output.vrrPolicy = spec.vrrPolicy;
+        output.rgbRange = spec.rgbRange;
+        output.hdr = spec.hdr;
+        output.wideColorGamut = spec.wideColorGamut;
+        output.sdrBrightness = spec.sdrBrightness;
+        output.edrPolicy = spec.edrPolicy;
+        output.capabilities = spec.capabilities;
+        result.append(output);
+    }
+    return result;
+}
+
+PresetsDelta PresetsService::getPresetsSince(qulonglong revision)
+{
+    PresetsDelta delta;
+    delta.revision = m_presets->revision();
+
+    // Unknown or too old to reconstruct removals from, the client has to start over
+    delta.fullResync = revision == 0 || revision > delta.revision || revision < m_presets->oldestTrackedRevision();
+
+    if (delta.fullResync) {
+        delta.added = listPresets();
+        return delta;
+    }
 
-        if (!shortcut.isEmpty()) {
-            registerShortcut(presetId, shortcut);
+    const QStringList changedIds = m_presets->presetsChangedSince(revision);
+    for (const QString &presetId : changedIds) {
+        const PresetSummary summary = buildPresetSummary(*m_presets->preset(presetId));
+        if (m_presets->presetAddedRevision(presetId) > revision) {
+            delta.added.append(summary);
+        } else {
+            delta.changed.append(summary);
         }
     }
+    delta.removed = m_presets->presetsRemovedSince(revision);
+    return delta;
 }
 
-QHash<QString, QVariantMap> PresetsService::buildPresetOutputsMap(const QVariantList &presetOutputsList) const
+void PresetsService::emitPresetsChanged(const QStringList &changedPresetIds, quint64 fromRevision, quint64 revision)
 {
-    QHash<QString, QVariantMap> outputsMap;
-    for (const auto &outputVariant : presetOutputsList) {
-        const QVariantMap outputMap = outputVariant.toMap();
-        const QString outputId = outputMap.value(QStringLiteral("id")).toString();
-        if (!outputId.isEmpty()) {
-            outputsMap[outputId] = outputMap;
+    PresetSummaryList changedPresets;
+    QStringList removedPresetIds;
+
+    for (const QString &presetId : changedPresetIds) {
+        if (const DisplayPreset *preset = m_presets->preset(presetId)) {
+            changedPresets.append(buildPresetSummary(*preset));
+        } else {
+            removedPresetIds.append(presetId);
         }
     }
-    return outputsMap;
+
+    Q_EMIT presetsChanged(changedPresets, removedPresetIds, fromRevision, revision);
 }
 
-void PresetsService::applyPresetToOutput(const KScreen::OutputPtr &output, const QVariantMap &presetOutputMap, KScreen::ConfigPtr config) const
+void PresetsService::emitPresetStatusChanged(const QStringList &changedPresetIds, quint64 fromRevision, quint64 revision)
 {
-    // Apply basic output settings - enable/disable first
-    const bool enabled = presetOutputMap.value(QStringLiteral("enabled"), false).toBool();
-    output->setEnabled(enabled);
+    PresetStatusList statuses;
 
-    if (!enabled) {
-        return;
-    }
+    for (const QString &presetId : changedPresetIds) {
+        if (m_presets->rowOf(presetId) < 0) {
+            continue;
+        }
 
-    // Apply mode
-    const QString modeId = presetOutputMap.value(QStringLiteral("currentModeId")).toString();
-    if (!modeId.isEmpty() && output->modes().contains(modeId)) {
-        output->setCurrentModeId(modeId);
+        statuses.append(PresetStatus{presetId, m_presets->isPresetAvailable(presetId), m_presets->isPresetCurrent(presetId)});
     }
 
-    // Apply scale
-    const qreal scale = presetOutputMap.value(QStringLiteral("scale"), 1.0).toReal();
-    output->setScale(scale);
+    if (!statuses.isEmpty()) {
+        Q_EMIT presetStatusChanged(statuses, fromRevision, revision);
+    }
+}
 
-    // Apply rotation
-    const int rotation = presetOutputMap.value(QStringLiteral("rotation"), 1).toInt();
-    output->setRotation(static_cast<KScreen::Output::Rotation>(rotation));
+void PresetsService::flushPendingSignals()
+{
+    // Everything that changed since the last signal, found by comparing revisions
+    const quint64 revision = m_presets->revision();
+    const quint64 since = std::exchange(m_signalledRevision, revision);
+
+    QStringList modifiedIds = m_presets->presetsRemovedSince(since);
+    QStringList statusIds;
+    const QStringList changedIds = m_presets->presetsChangedSince(since);
+    for (const QString &presetId : changedIds) {
+        // A full entry already carries the status
+        if (m_presets->presetContentRevision(presetId) > since) {
+            modifiedIds.append(presetId);
+        } else {
+            statusIds.append(presetId);
+        }
+    }
 
-    // Apply position
-    const QVariantMap posMap = presetOutputMap.value(QStringLiteral("pos")).toMap();
-    const QPoint position(posMap.value(QStringLiteral("x"), 0).toInt(), posMap.value(QStringLiteral("y"), 0).toInt());
-    output->setPos(position);
+    if (!modifiedIds.isEmpty()) {
+        emitPresetsChanged(modifiedIds, since, revision);
+    }
+    emitPresetStatusChanged(statusIds, since, revision);
+}
 
-    // Apply priority (after enabled state is set to ensure correct ordering)
-    const uint32_t priority = presetOutputMap.value(QStringLiteral("priority"), 1).toUInt();
-    config->setOutputPriority(output, priority);
+void PresetsService::onPresetStatusChanged()
+{
+    // Not restarted while running, a steady stream of events must not postpone the signal
+    if (!m_signalTimer->isActive()) {
+        m_signalTimer->start();
+    }
 }
 
-void PresetsService::registerShortcut(const QString &presetId, const QKeySequence &shortcut)
+void PresetsService::reconcileShortcuts()
 {
-    if (shortcut.isEmpty()) {
-        return;
+    // Every KGlobalAccel call is a round trip to kglobalaccel, only touch what differs
+    QHash<QString, QKeySequence> wanted;
+    for (const DisplayPreset &preset : m_presets->presets()) {
+        if (!preset.shortcut.isEmpty()) {
+            wanted.insert(preset.id, preset.shortcut);
+        }
+    }
+
+    for (auto it = m_shortcutActions.begin(); it != m_shortcutActions.end();) {
+        if (wanted.contains(it.key())) {
+            ++it;
+            continue;
+        }
+        KGlobalAccel::self()->removeAllShortcuts(it->action);
+        it->action->deleteLater();
+        it = m_shortcutActions.erase(it);
+    }
+
+    for (auto it = wanted.cbegin(); it != wanted.cend(); ++it) {
+        const auto registered = m_shortcutActions.constFind(it.key());
+        if (registered == m_shortcutActions.cend()) {
+            registerShortcut(it.key(), it.value());
+        } else if (registered->shortcut != it.value()) {
+            KGlobalAccel::self()->setShortcut(registered->action, {it.value()}, KGlobalAccel::NoAutoloading);
+            m_shortcutActions[it.key()].shortcut = it.value();
+        }
     }
+}
 
+void PresetsService::registerShortcut(const QString &presetId, const QKeySequence &shortcut)
+{
     auto action = new QAction(this);
     action->setObjectName(QStringLiteral("preset_%1").arg(presetId));
     action->setText(i18n("Apply Display Preset"));
@@ -341,80 +506,52 @@ void PresetsService::registerShortcut(const QString &presetId, const QKeySequenc
         applyPreset(presetId);
     });
 
-    KGlobalAccel::self()->setShortcut(action, {shortcut});
-    m_shortcutActions[presetId] = action;
+    // The presets file is authoritative, do not pick up a binding kglobalaccel remembers
+    KGlobalAccel::self()->setShortcut(action, {shortcut}, KGlobalAccel::NoAutoloading);
+    m_shortcutActions.insert(presetId, ShortcutBinding{action, shortcut});
 }
 
-void PresetsService::onPresetsModelChanged()
+void PresetsService::rebuildApplyPlans()
 {
-    const QStringList changedPresetIds = detectChangedPresets();
-    if (!changedPresetIds.isEmpty()) {
-        emitPresetsChanged(changedPresetIds);
+    m_applyPlans.clear();
+    if (!m_config) {
+        return;
     }
 
-    // Update cached presets for next comparison
-    m_previousPresets = getPresets();
+    for (int row = 0; row < m_presets->rowCount(); ++row) {
+        const QString presetId = m_presets->data(m_presets->index(row, 0), Presets::IdRole).toString();
+        updateApplyPlan(presetId);
+    }
+
+    qCDebug(KDISPLAYPRESETS_DAEMON) << "Prepared apply plans for" << m_applyPlans.count() << "presets";
 }
 
-QStringList PresetsService::detectChangedPresets() const
+void PresetsService::updateApplyPlan(const QString &presetId)
 {
-    QStringList changedIds;
+    m_applyPlans.remove(presetId);
 
-    // We need to cast away const to call getPresets() - this is safe for read-only access
-    const QVariantList currentPresets = const_cast<PresetsService *>(this)->getPresets();
-
-    // Convert lists to maps for easier comparison
-    QHash<QString, QVariantMap> previousMap;
-    for (const auto &preset : m_previousPresets) {
-        const QVariantMap presetMap = preset.toMap();
-        previousMap[presetMap.value(QStringLiteral("presetId")).toString()] = presetMap;
+    // Only presets whose outputs are all connected can be applied
+    const DisplayPreset *preset = m_presets->preset(presetId);
+    if (!m_config || !preset || !m_presets->isPresetAvailable(presetId)) {
+        return;
     }
 
-    QHash<QString, QVariantMap> currentMap;
-    for (const auto &preset : currentPresets) {
-        const QVariantMap presetMap = preset.toMap();
-        currentMap[presetMap.value(QStringLiteral("presetId")).toString()] = presetMap;
+    const ApplyPlan plan = ApplyPlan::build(presetId, preset->configuration, m_config);
+    if (plan.isValid()) {
+        m_applyPlans.insert(presetId, plan);
     }
+}
 
-    // Check for new or modified presets
-    for (auto it = currentMap.constBegin(); it != currentMap.constEnd(); ++it) {
-        const QString presetId = it.key();
-        const QVariantMap currentPreset = it.value();
-
-        if (!previousMap.contains(presetId)) {
-            // New preset
-            changedIds.append(presetId);
-        } else {
-            // Check if preset was modified
-            const QVariantMap previousPreset = previousMap.value(presetId);
-
-            // Compare key fields (excluding isAvailable/isCurrent which change based on screen config)
-            const QStringList fieldsToCompare = {QStringLiteral("name"), QStringLiteral("description"), QStringLiteral("shortcut"), QStringLiteral("lastUsed")};
-
-            bool isModified = false;
-            for (const QString &field : fieldsToCompare) {
-                if (currentPreset.value(field) != previousPreset.value(field)) {
-                    isModified = true;
-                    break;
-                }
-            }
-
-            if (isModified) {
-                changedIds.append(presetId);
-            }
-        }
+void PresetsService::onPresetsModelChanged(const QStringList &changedPresetIds)
+{
+    for (const QString &presetId : changedPresetIds) {
+        updateApplyPlan(presetId);
     }
 
-    // Check for deleted presets
-    for (auto it = previousMap.constBegin(); it != previousMap.constEnd(); ++it) {
-        const QString presetId = it.key();
-        if (!currentMap.contains(presetId)) {
-            // Preset was deleted - emit it with deleted flag
-            changedIds.append(presetId);
-        }
+    // The model reports exactly which presets were added, modified or removed
+    if (!changedPresetIds.isEmpty() && !m_signalTimer->isActive()) {
+        m_signalTimer->start();
     }
-
-    return changedIds;
 }
 
 #include "moc_presetsservice.cpp"
@@ -6,12 +6,17 @@
 
 #pragma once
 
+#include "applyplan.h"
+#include "applyscheduler.h"
+#include "common/dbustypes.h"
 #include "common/presets.h"
 
 #include <QAction>
 #include <QModelIndex>
 #include <QObject>
-#include <QTimer>
+
+class AdaptiveDebouncer;
+class QTimer;
 
 namespace KScreen
 {
@@ -23,6 +28,9 @@ class PresetsService : public QObject
 {
     Q_OBJECT
     Q_CLASSINFO("D-Bus Interface", "org.kde.kdisplaypresets")
+    // Current hotplug debounce window and how long the last status update took, in milliseconds
+    Q_PROPERTY(int debounceInterval READ debounceInterval)
+    Q_PROPERTY(qint64 lastUpdateLatency READ lastUpdateLatency)
 
 public:
     explicit PresetsService(QObject *parent = nullptr, const QString &customPresetsFile = QString());
@@ -30,32 +38,74 @@ public:
 
     bool init();
 
+    // Upper bound of the adaptive debounce window, 0 handles every config change on its own
+    void setDebounceInterval(int interval);
+    int debounceInterval() const;
+    qint64 lastUpdateLatency() const;
+
 public Q_SLOTS:
-    Q_SCRIPTABLE void applyPreset(const QString &presetId);
+    // Returns a request id, the outcome is reported by presetApplied()
+    Q_SCRIPTABLE uint applyPreset(const QString &presetId);
+    // Every preset including its full configuration
     Q_SCRIPTABLE QVariantList getPresets();
+    // Every preset without its configuration, see common/dbustypes.h for the types
+    Q_SCRIPTABLE PresetSummaryList listPresets();
+    Q_SCRIPTABLE PresetOutputDataList getPresetConfiguration(const QString &presetId);
+    // Presets added, changed and removed after revision
+    Q_SCRIPTABLE PresetsDelta getPresetsSince(qulonglong revision);
 
 Q_SIGNALS:
-    Q_SCRIPTABLE void presetsChanged(const QVariantList &changedPresets);
+    // Both signals cover the changes after fromRevision up to revision. A client
+    // holding an older revision than fromRevision missed some and should call getPresetsSince()
+    Q_SCRIPTABLE void presetsChanged(const PresetSummaryList &changedPresets, const QStringList &removedPresetIds, qulonglong fromRevision, qulonglong revision);
+    // Presets whose status flipped
+    Q_SCRIPTABLE void presetStatusChanged(const PresetStatusList &statuses, qulonglong fromRevision, qulonglong revision);
+    // outcome is one of "applied", "superseded", "failed" or "unchanged"
+    Q_SCRIPTABLE void presetApplied(uint requestId, const QString &presetId, const QString &outcome);
     void errorOccurred(const QString &error);
 
 private Q_SLOTS:
     void configChanged();
+    void onConfigBurstStarted();
+    void onConfigBurstSettled(bool moreEvents);
     void configReady(KScreen::ConfigOperation *op);
-    void initShortcuts();
-    void onPresetsModelChanged();
+    void reconcileShortcuts();
+    void onPresetsModelChanged(const QStringList &changedPresetIds);
+    void onPresetStatusChanged();
+    void flushPendingSignals();
+    void onApplyRequestFinished(uint requestId, const QString &presetId, ApplyScheduler::Outcome outcome, const QString &errorString, qint64 elapsed);
 
 private:
-    void updatePresetScreenConfiguration();
-    void emitPresetsChanged(const QStringList &changedPresetIds = {});
+    bool updatePresetScreenConfiguration();
+    void recordUpdateLatency();
+    void fetchScreenConfiguration();
+    ApplyPlan buildApplyPlan(const QString &presetId, const KScreen::ConfigPtr &baseConfig, QString *errorString);
+    void emitPresetsChanged(const QStringList &changedPresetIds, quint64 fromRevision, quint64 revision);
+    void emitPresetStatusChanged(const QStringList &changedPresetIds, quint64 fromRevision, quint64 revision);
+    PresetSummary buildPresetSummary(const DisplayPreset &preset) const;
     QVariantMap buildPresetMap(const QModelIndex &index) const;
-    QHash<QString, QVariantMap> buildPresetOutputsMap(const QVariantList &presetOutputsList) const;
-    void applyPresetToOutput(const KScreen::OutputPtr &output, const QVariantMap &presetOutputMap, KScreen::ConfigPtr config) const;
+    void rebuildApplyPlans();
+    void updateApplyPlan(const QString &presetId);
     void registerShortcut(const QString &presetId, const QKeySequence &shortcut);
-    QStringList detectChangedPresets() const;
 
     Presets *m_presets = nullptr;
     KScreen::ConfigMonitor *m_configMonitor = nullptr;
-    QTimer *m_configUpdateTimer = nullptr;
-    QHash<QString, QAction *> m_shortcutActions;
-    QVariantList m_previousPresets; // Cache of previous presets for change detection
+    AdaptiveDebouncer *m_configDebouncer = nullptr;
+    qint64 m_lastUpdateLatency = 0;
+    // Live screen configuration, kept up to date by m_configMonitor
+    KScreen::ConfigPtr m_config;
+    bool m_fetchingConfig = false;
+    ApplyScheduler *m_applyScheduler = nullptr;
+    // Ready-to-submit configurations of the available presets
+    QHash<QString, ApplyPlan> m_applyPlans;
+    // Registered global shortcuts by preset id, actions live as long as the binding
+    struct ShortcutBinding {
+        QAction *action = nullptr;
+        QKeySequence shortcut;
+    };
+    QHash<QString, ShortcutBinding> m_shortcutActions;
+
+    // Changes after this model revision wait for the next D-Bus signal
+    QTimer *m_signalTimer = nullptr;
+    quint64 m_signalledRevision = 0;
 };
@@ -8,6 +8,8 @@
 #include "kdisplaypresets_kcm_debug.h"
 #include "preset_manager.h"
 
+#include "common/presetthumbnailprovider.h"
+
 #include <KScreen/Config>
 #include <KScreen/ConfigMonitor>
 #include <KScreen/GetConfigOperation>
@@ -100,6 +102,11 @@ bool KCMDisplayPresets::isPresetCurrent(const QString &presetId) const
     return m_presetManager->isPresetCurrent(presetId);
 }
 
+bool KCMDisplayPresets::installThumbnailProvider(QObject *item)
+{
+    return PresetThumbnailProvider::install(item);
+}
+
 void KCMDisplayPresets::configReady(KScreen::ConfigOperation *op)
 {
     if (op->hasError()) {
@@ -112,10 +119,8 @@ void KCMDisplayPresets::configReady(KScreen::ConfigOperation *op)
 
     if (m_config) {
         m_configMonitor->addConfig(m_config);
+        // Re-evaluates every preset's status; rows that flipped emit dataChanged
         m_presetManager->setScreenConfiguration(m_config);
-        // Refresh preset status now that configuration is available
-        m_presetManager->refreshPresetStatus();
-        // Notify QML to update bindings (triggers _refreshTrigger)
         Q_EMIT outputConnect();
     }
 
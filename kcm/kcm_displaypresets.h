@@ -41,6 +41,8 @@ public:
     Q_INVOKABLE void loadPreset(const QString &presetId);
     Q_INVOKABLE bool isPresetAvailable(const QString &presetId) const;
     Q_INVOKABLE bool isPresetCurrent(const QString &presetId) const;
+    // False when thumbnails cannot be used and the views draw outputs live
+    Q_INVOKABLE bool installThumbnailProvider(QObject *item);
 
 Q_SIGNALS:
     void outputConnect();
@@ -9,6 +9,7 @@
 
 #include <KScreen/Mode>
 
+#include <QJsonObject>
 #include <QUuid>
 
 PresetManager::PresetManager(QObject *parent)
@@ -59,7 +60,7 @@ void PresetManager::savePreset(const QString &name, const QString &description,
     preset.description = description;
     preset.created = QDateTime::currentDateTime();
     preset.lastUsed = QDateTime::currentDateTime();
-    preset.configuration = configToVariantMap(config);
+    preset.configuration = PresetConfiguration(QJsonObject::fromVariantMap(configToVariantMap(config)));
 
     // Extract output IDs
     for (const auto &output : config->outputs()) {
@@ -93,7 +94,10 @@ void PresetManager::renamePreset(const QString &presetId, const QString &newName
 {
     DisplayPreset *preset = m_presets->findPreset(presetId);
     if (preset) {
-        preset->name = newName;
+        // Go through the model so views update; our own save does not trigger a reload
+        DisplayPreset updated = *preset;
+        updated.name = newName;
+        m_presets->updatePreset(presetId, updated);
         m_presets->saveToDisk();
     }
 }
@@ -102,7 +106,9 @@ void PresetManager::updatePresetDescription(const QString &presetId, const QStri
 {
     DisplayPreset *preset = m_presets->findPreset(presetId);
     if (preset) {
-        preset->description = newDescription;
+        DisplayPreset updated = *preset;
+        updated.description = newDescription;
+        m_presets->updatePreset(presetId, updated);
         m_presets->saveToDisk();
     }
 }
@@ -111,7 +117,9 @@ void PresetManager::updatePresetShortcut(const QString &presetId, const QKeySequ
 {
     DisplayPreset *preset = m_presets->findPreset(presetId);
     if (preset) {
-        preset->shortcut = shortcut;
+        DisplayPreset updated = *preset;
+        updated.shortcut = shortcut;
+        m_presets->updatePreset(presetId, updated);
         m_presets->saveToDisk();
     }
 }
@@ -12,29 +12,20 @@ import org.kde.kirigami as Kirigami
 Item {
     id: presetOutput
 
+    // One entry of previewGeometry.outputs, its rectangle is relative to the layout
     property var outputData: null
-    property real scaleFactor: 1.0
+    property real layoutWidth: 0
+    property real layoutHeight: 0
     property real xOffset: 0
     property real yOffset: 0
-    property var bounds: ({ minX: 0, minY: 0, maxX: 1920, maxY: 1080 })
 
-    // KScreen Output::Capability enum values (from kscreen/output.h)
-    readonly property int capabilityHighDynamicRange: 8      // 1 << 3
-    readonly property int capabilityExtendedDynamicRange: 2048  // 1 << 11
-
-    readonly property var pos: outputData?.pos || { x: 0, y: 0 }
-    readonly property var mode: outputData?.mode || { width: 1920, height: 1080 }
-    readonly property real scale: outputData?.scale || 1
-    readonly property real monitorWidth: mode.width / scale
-    readonly property real monitorHeight: mode.height / scale
     // For static preset visualization, always show as available
     readonly property bool outputAvailable: true
 
-    visible: outputData?.enabled !== false
-    x: ((pos.x || 0) - bounds.minX) * scaleFactor + xOffset
-    y: ((pos.y || 0) - bounds.minY) * scaleFactor + yOffset
-    width: monitorWidth * scaleFactor
-    height: monitorHeight * scaleFactor
+    x: (outputData?.x || 0) * layoutWidth + xOffset
+    y: (outputData?.y || 0) * layoutHeight + yOffset
+    width: (outputData?.width || 0) * layoutWidth
+    height: (outputData?.height || 0) * layoutHeight
     opacity: outputAvailable ? 1.0 : 0.4
 
     Rectangle {
@@ -90,30 +81,8 @@ Item {
             Text {
                 anchors.horizontalCenter: parent.horizontalCenter
                 width: parent.parent.width - 4
-                text: {
-                    // Use displayName if available (generated by Utils::outputName())
-                    var displayName = presetOutput.outputData?.displayName;
-                    if (displayName) {
-                        return displayName;
-                    }
-
-                    var name = "";
-                    var vendor = presetOutput.outputData?.vendor || "";
-                    var model = presetOutput.outputData?.model || "";
-
-                    if (vendor) {
-                        name = vendor + " ";
-                    }
-                    if (model) {
-                        name += model + " ";
-                    }
-
-                    if (name.trim()) {
-                        return name.trim();
-                    }
-
-                    return presetOutput.outputData?.name || i18nc("@label default monitor name", "Monitor");
-                }
+                // Display name generated by Utils::outputName(), or the connector name
+                text: presetOutput.outputData?.name || i18nc("@label default monitor name", "Monitor")
                 color: outputAvailable ? Kirigami.Theme.textColor : Kirigami.Theme.disabledTextColor
                 font.pixelSize: Math.max(6, Math.min(12, parent.parent.height / 5))
                 font.bold: false
@@ -131,29 +100,14 @@ Item {
                         return i18nc("@info Monitor is not currently connected", "Missing");
                     }
 
-                    var res = (mode.width || 1920) + "×" + (mode.height || 1080);
-                    var refresh = Math.round(mode.refreshRate || 60) + "Hz";
-                    var extras = [];
-
-                    // Get monitor capabilities
-                    var capabilities = presetOutput.outputData?.capabilities || 0;
-
-                    // Check for HDR - monitor must support it and have it enabled
-                    var supportsHdr = (capabilities & capabilityHighDynamicRange) !== 0;
-                    if (presetOutput.outputData?.hdr && supportsHdr) {
-                        extras.push("<b>" + i18nc("@label HDR indicator", "HDR") + "</b>");
-                    }
+                    var result = presetOutput.outputData?.modeLabel || "";
 
-                    // Check for EDR policy - 1 means Always enabled, and monitor must support EDR
-                    var edrPolicy = presetOutput.outputData?.edr_policy;
-                    var supportsEdr = (capabilities & capabilityExtendedDynamicRange) !== 0;
-                    if (edrPolicy === 1 && supportsEdr) {
-                        extras.push("<b>" + i18nc("@label EDR indicator", "EDR") + "</b>");
+                    // Only set when the monitor supports them, see PresetConfiguration::previewOutputs()
+                    if (presetOutput.outputData?.hdr) {
+                        result += " <b>" + i18nc("@label HDR indicator", "HDR") + "</b>";
                     }
-
-                    var result = res + " " + refresh;
-                    if (extras.length > 0) {
-                        result += " " + extras.join(" ");
+                    if (presetOutput.outputData?.edr) {
+                        result += " <b>" + i18nc("@label EDR indicator", "EDR") + "</b>";
                     }
 
                     return result;
@@ -169,10 +123,7 @@ Item {
 
             Text {
                 anchors.horizontalCenter: parent.horizontalCenter
-                text: {
-                    var scale = presetOutput.outputData?.scale || 1;
-                    return i18nc("@info monitor scale factor", "Scale: %1%", Math.round(scale * 100));
-                }
+                text: i18nc("@info monitor scale factor", "Scale: %1%", presetOutput.outputData?.scalePercent || 100)
                 color: outputAvailable ? Kirigami.Theme.textColor : Kirigami.Theme.disabledTextColor
                 font.pixelSize: Math.max(5, Math.min(9, parent.parent.height / 7))
                 opacity: 0.7
@@ -14,20 +14,11 @@ KCM.SimpleKCM {
     id: presetPage
 
     property bool canSavePreset: true
-
-    // Force refresh when monitor connection state changes
-    property bool _refreshTrigger: false
+    // Evaluated on first use, before any thumbnail is requested
+    readonly property bool thumbnails: kcm ? kcm.installThumbnailProvider(presetPage) : false
 
     title: i18nc("@title:window Display presets management", "Display Presets")
 
-    // Connect to monitor connection changes to refresh preset availability
-    Connections {
-        target: kcm
-        function onOutputConnect() {
-            _refreshTrigger = !_refreshTrigger;
-        }
-    }
-
     actions: Kirigami.Action {
         text: i18nc("@action:button Save current display configuration", "Save Current…")
         icon.name: "list-add"
@@ -44,6 +35,12 @@ KCM.SimpleKCM {
         model: kcm ? kcm.presetModel : null
 
         delegate: QQC2.ItemDelegate {
+            id: presetDelegate
+
+            // Status is evaluated once per screen configuration change in the model
+            readonly property bool available: model.isAvailable || false
+            readonly property bool current: model.isCurrent || false
+
             width: ListView.view.width
             height: Math.max(Kirigami.Units.gridUnit * 5, buttonColumn.implicitHeight + Kirigami.Units.largeSpacing * 2)
 
@@ -96,10 +93,7 @@ KCM.SimpleKCM {
                         color: Kirigami.Theme.negativeTextColor
                         font.pointSize: Kirigami.Theme.smallFont.pointSize
                         elide: Text.ElideRight
-                        visible: {
-                            _refreshTrigger; // Force binding update
-                            return kcm && !kcm.isPresetAvailable(model.presetId);
-                        }
+                        visible: !presetDelegate.available
                     }
                 }
 
@@ -111,14 +105,9 @@ KCM.SimpleKCM {
 
                     PresetView {
                         anchors.fill: parent
-                        // Ensure outputs is correctly passed as array
-                        outputs: {
-                            return model.configuration ? model.configuration.outputs : [];
-                        }
-                        presetAvailable: {
-                            _refreshTrigger; // Force binding update
-                            return !kcm || kcm.isPresetAvailable(model.presetId);
-                        }
+                        geometry: model.previewGeometry
+                        presetAvailable: presetDelegate.available
+                        thumbnail: presetPage.thumbnails
                     }
                 }
 
@@ -133,36 +122,21 @@ KCM.SimpleKCM {
                         id: applyButton
                         Layout.fillWidth: true
                         Layout.preferredWidth: Kirigami.Units.gridUnit * 8
-                        text: {
-                            _refreshTrigger; // Force binding update
-                            return kcm && kcm.isPresetCurrent && kcm.isPresetCurrent(model.presetId)
-                                  ? i18nc("@info:status Current preset is active", "Current")
-                                  : i18nc("@action:button Apply display preset", "Apply");
-                        }
-                        icon.name: {
-                            _refreshTrigger; // Force binding update
-                            return kcm && kcm.isPresetCurrent && kcm.isPresetCurrent(model.presetId)
-                                   ? "checkmark"
-                                   : "dialog-ok-apply";
-                        }
+                        text: presetDelegate.current
+                              ? i18nc("@info:status Current preset is active", "Current")
+                              : i18nc("@action:button Apply display preset", "Apply")
+                        icon.name: presetDelegate.current ? "checkmark" : "dialog-ok-apply"
                         display: QQC2.AbstractButton.TextBesideIcon
-                        enabled: {
-                            _refreshTrigger; // Force binding update
-                            return kcm && kcm.isPresetAvailable && kcm.isPresetAvailable(model.presetId) &&
-                                   (!kcm.isPresetCurrent || !kcm.isPresetCurrent(model.presetId));
-                        }
+                        enabled: presetDelegate.available && !presetDelegate.current
                         onClicked: {
                             if (kcm && typeof kcm.loadPreset === "function") {
                                 kcm.loadPreset(model.presetId)
                             }
                         }
 
-                        QQC2.ToolTip.text: {
-                            _refreshTrigger; // Force binding update
-                            return kcm && kcm.isPresetCurrent && kcm.isPresetCurrent(model.presetId)
-                                   ? i18nc("@info:tooltip", "This display preset is currently active")
-                                   : i18nc("@info:tooltip", "Apply this display preset configuration");
-                        }
+                        QQC2.ToolTip.text: presetDelegate.current
+                                           ? i18nc("@info:tooltip", "This display preset is currently active")
+                                           : i18nc("@info:tooltip", "Apply this display preset configuration")
                         QQC2.ToolTip.visible: hovered
                         QQC2.ToolTip.delay: 1000
                     }
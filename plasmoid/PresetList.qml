@@ -19,6 +19,7 @@ ColumnLayout {
     property var loadPresetFunc
     property real plasmoidHeight: 0
     property var plasmoidRoot: null
+    property bool thumbnails: false
 
     spacing: Kirigami.Units.smallSpacing
 
@@ -71,8 +72,9 @@ ColumnLayout {
                                 height: parent.implicitHeight - Kirigami.Units.largeSpacing * 2
                                 x: Kirigami.Units.largeSpacing
                                 y: Kirigami.Units.largeSpacing
-                                outputs: model.configuration ? model.configuration.outputs : []
+                                geometry: model.previewGeometry
                                 presetAvailable: presetItem.available
+                                thumbnail: presetList.thumbnails
                             }
                         }
                     }
@@ -7,85 +7,66 @@
 import QtQuick
 import QtQuick.Layouts
 import QtQuick.Controls as QQC2
+import QtQuick.Window
 import org.kde.kirigami as Kirigami
 
 Item {
     id: presetView
 
-    property var outputs: []
+    // Normalized layout from the model's previewGeometry role
+    property var geometry: null
     property bool presetAvailable: true
-
-    // Calculate own width based on aspect ratio when height is set
-    width: {
-        if (layoutWidth <= 0 || layoutHeight <= 0 || height <= 0) {
-            return height * (16/9); // Fallback aspect ratio
+    // Show one cached image from PresetThumbnailProvider instead of an item per output
+    property bool thumbnail: false
+
+    readonly property var outputs: geometry?.outputs || []
+    readonly property real aspectRatio: geometry?.aspectRatio || 16 / 9
+    readonly property real margin: 15
+
+    // Own width follows the layout's aspect ratio when height is set
+    width: height * aspectRatio
+
+    // Largest area with the layout's aspect ratio inside the margins, centered
+    readonly property real layoutHeight: Math.max(0, Math.min(height - margin * 2, (width - margin * 2) / aspectRatio))
+    readonly property real layoutWidth: layoutHeight * aspectRatio
+    readonly property real xOffset: (width - layoutWidth) / 2
+    readonly property real yOffset: (height - layoutHeight) / 2
+
+    Image {
+        x: presetView.xOffset
+        y: presetView.yOffset
+        width: presetView.layoutWidth
+        height: presetView.layoutHeight
+        // Logical height, the provider is asked for it times the device pixel ratio and
+        // answers with the next of its fixed sizes, which is scaled to fit
+        sourceSize.height: height
+        asynchronous: true
+        visible: presetView.thumbnail
+        source: {
+            if (!presetView.thumbnail || presetView.outputs.length === 0 || width <= 0 || height <= 0) {
+                return "";
+            }
+            // Colors go in without their leading '#'
+            return "image://kdisplaypresets/" + [
+                Screen.devicePixelRatio,
+                String(Kirigami.Theme.backgroundColor).slice(1),
+                String(Kirigami.Theme.textColor).slice(1),
+                String(Kirigami.Theme.highlightColor).slice(1),
+                String(Kirigami.Theme.highlightedTextColor).slice(1),
+                presetView.geometry.thumbnailKey,
+            ].join("/");
         }
-        return height * (layoutWidth / layoutHeight);
     }
 
-    // Calculate bounds for real positioning
-    readonly property var bounds: {
-        if (!outputs || outputs.length === 0) {
-            return { minX: 0, minY: 0, maxX: 1920, maxY: 1080 };
-        }
-
-        var minX = 999999, minY = 999999, maxX = -999999, maxY = -999999;
-
-        for (var i = 0; i < outputs.length; i++) {
-            var output = outputs[i];
-            if (!output.enabled) continue;
-
-            var pos = output.pos || { x: 0, y: 0 };
-            var mode = output.mode || { width: 1920, height: 1080 };
-            var scale = output.scale || 1;
-
-            var w = mode.width / scale;
-            var h = mode.height / scale;
-            var x = pos.x || 0;
-            var y = pos.y || 0;
-
-            minX = Math.min(minX, x);
-            minY = Math.min(minY, y);
-            maxX = Math.max(maxX, x + w);
-            maxY = Math.max(maxY, y + h);
-        }
-
-        if (minX === 999999) {
-            return { minX: 0, minY: 0, maxX: 1920, maxY: 1080 };
-        }
-
-        return { minX: minX, minY: minY, maxX: maxX, maxY: maxY };
-    }
-
-    readonly property real layoutWidth: bounds.maxX - bounds.minX
-    readonly property real layoutHeight: bounds.maxY - bounds.minY
-
-    // Scale to fit container - similar to ScreenView's relativeFactor
-    readonly property real scaleFactor: {
-        if (layoutWidth <= 0 || layoutHeight <= 0 || width <= 0 || height <= 0) {
-            return 0.1;
-        }
-        var margin = 15; // Increased margin for better spacing
-        var scaleX = (width - margin * 2) / layoutWidth;
-        var scaleY = (height - margin * 2) / layoutHeight;
-        var finalScale = Math.min(scaleX, scaleY);
-
-        return finalScale;
-    }
-
-    readonly property real xOffset: (width - layoutWidth * scaleFactor) / 2 // Center horizontally
-    readonly property real yOffset: (height - layoutHeight * scaleFactor) / 2
-
-    // Real positioned monitors using Repeater with PresetOutput delegate
     Repeater {
-        model: outputs
+        model: presetView.thumbnail ? [] : presetView.outputs
 
         delegate: PresetOutput {
             outputData: modelData
-            scaleFactor: presetView.scaleFactor
+            layoutWidth: presetView.layoutWidth
+            layoutHeight: presetView.layoutHeight
             xOffset: presetView.xOffset
             yOffset: presetView.yOffset
-            bounds: presetView.bounds
         }
     }
 
@@ -7,34 +7,38 @@
 #include "kdisplaypresets_applet.h"
 #include "kdisplaypresets_applet_debug.h"
 
-#include <QDBusArgument>
+#include "common/presetthumbnailprovider.h"
+#include "common/previewgeometry.h"
+
 #include <QDBusConnection>
-#include <QDBusInterface>
-#include <QDBusReply>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusServiceWatcher>
+#include <QSet>
+
+#include <utility>
 
 K_PLUGIN_CLASS_WITH_JSON(KDisplayPresetsApplet, "metadata.json")
 
+static const QString s_service = QStringLiteral("org.kde.kdisplaypresets");
+static const QString s_path = QStringLiteral("/");
+static const QString s_interface = QStringLiteral("org.kde.kdisplaypresets");
+
+// Plain method calls, QDBusInterface would introspect the daemon synchronously
+static QDBusMessage presetsCall(const QString &method)
+{
+    return QDBusMessage::createMethodCall(s_service, s_path, s_interface, method);
+}
+
 KDisplayPresetsApplet::KDisplayPresetsApplet(QObject *parent, const KPluginMetaData &data, const QVariantList &args)
     : Plasma::Applet(parent, data, args)
-    , m_presetsInterface(new QDBusInterface(QStringLiteral("org.kde.kdisplaypresets"),
-                                            QStringLiteral("/"),
-                                            QStringLiteral("org.kde.kdisplaypresets"),
-                                            QDBusConnection::sessionBus(),
-                                            this))
-    , m_presetModel(new PresetModel(m_presetsInterface, this))
+    , m_presetModel(new PresetModel(this))
 {
 }
 
 KDisplayPresetsApplet::~KDisplayPresetsApplet() = default;
 
-void KDisplayPresetsApplet::init()
-{
-    // Initial load of presets
-    if (m_presetModel) {
-        m_presetModel->refreshPresets();
-    }
-}
-
 QAbstractItemModel *KDisplayPresetsApplet::presetModel() const
 {
     return m_presetModel;
@@ -42,37 +46,41 @@ QAbstractItemModel *KDisplayPresetsApplet::presetModel() const
 
 void KDisplayPresetsApplet::loadPreset(const QString &presetId)
 {
-    if (!m_presetsInterface || !m_presetsInterface->isValid()) {
-        return;
-    }
+    QDBusMessage message = presetsCall(QStringLiteral("applyPreset"));
+    message << presetId;
+    QDBusConnection::sessionBus().asyncCall(message);
+}
 
-    m_presetsInterface->asyncCall(QStringLiteral("applyPreset"), presetId);
+bool KDisplayPresetsApplet::installThumbnailProvider(QObject *item)
+{
+    return PresetThumbnailProvider::install(item);
 }
 
 // PresetModel implementation
-PresetModel::PresetModel(QDBusInterface *presetsInterface, QObject *parent)
+PresetModel::PresetModel(QObject *parent)
     : QAbstractListModel(parent)
-    , m_presetsInterface(presetsInterface)
-{
-    // Connect to D-Bus signal for preset availability changes
-    if (m_presetsInterface && m_presetsInterface->isValid()) {
-        qCDebug(KDISPLAYPRESETS_APPLET) << "PresetModel: D-Bus interface is valid, connecting signals and loading presets";
-        QDBusConnection::sessionBus().connect(QStringLiteral("org.kde.kdisplaypresets"),
-                                              QStringLiteral("/"),
-                                              QStringLiteral("org.kde.kdisplaypresets"),
-                                              QStringLiteral("presetsChanged"),
-                                              this,
-                                              SLOT(onPresetAvailabilityChanged()));
-
-        // Load initial presets
-        refreshPresets();
-    } else {
-        qCWarning(KDISPLAYPRESETS_APPLET) << "PresetModel: D-Bus interface is NOT valid!"
-                                  << "Interface exists:" << (m_presetsInterface != nullptr)
-                                  << "Is valid:" << (m_presetsInterface ? m_presetsInterface->isValid() : false)
-                                  << "Service:" << (m_presetsInterface ? m_presetsInterface->service() : "null")
-                                  << "Last error:" << (m_presetsInterface ? m_presetsInterface->lastError().message() : "no interface");
-    }
+{
+    registerPresetsDBusTypes();
+
+    QDBusConnection::sessionBus().connect(s_service,
+                                          s_path,
+                                          s_interface,
+                                          QStringLiteral("presetsChanged"),
+                                          this,
+                                          SLOT(onPresetsChanged(PresetSummaryList, QStringList, qulonglong, qulonglong)));
+    QDBusConnection::sessionBus().connect(s_service,
+                                          s_path,
+                                          s_interface,
+                                          QStringLiteral("presetStatusChanged"),
+                                          this,
+                                          SLOT(onPresetStatusChanged(PresetStatusList, qulonglong, qulonglong)));
+
+    // A restarted daemon counts revisions from scratch
+    auto *serviceWatcher = new QDBusServiceWatcher(s_service, QDBusConnection::sessionBus(), QDBusServiceWatcher::WatchForOwnerChange, this);
+    connect(serviceWatcher, &QDBusServiceWatcher::serviceOwnerChanged, this, &PresetModel::onServiceOwnerChanged);
+
+    // Load initial presets, the call activates the daemon if needed
+    refreshPresets();
 }
 
 int PresetModel::rowCount(const QModelIndex &parent) const
@@ -87,35 +95,28 @@ QVariant PresetModel::data(const QModelIndex &index, int role) const
         return QVariant();
     }
 
-    const QVariant &presetVariant = m_presets.at(index.row());
-    const QVariantMap preset = presetVariant.toMap();
+    const PresetRow &row = m_presets.at(index.row());
+    const PresetSummary &preset = row.summary;
 
     switch (role) {
     case IdRole:
-        return preset[QStringLiteral("presetId")];
+        return preset.presetId;
     case NameRole:
-        return preset[QStringLiteral("name")];
+        return preset.name;
     case DescriptionRole:
-        return preset[QStringLiteral("description")];
+        return preset.description;
     case LastUsedRole:
-        return preset[QStringLiteral("lastUsed")];
+        return preset.lastUsed;
     case OutputCountRole:
-        return preset[QStringLiteral("outputCount")];
+        return preset.outputCount;
     case ShortcutRole:
-        return preset[QStringLiteral("shortcut")];
-    case ConfigurationRole: {
-        QVariant configVar = preset[QStringLiteral("configuration")];
-        if (configVar.toMap().contains(QStringLiteral("outputs"))) {
-            QVariantList outputs = configVar.toMap()[QStringLiteral("outputs")].toList();
-            qCDebug(KDISPLAYPRESETS_APPLET) << "PresetModel: Returning configuration with" << outputs.count() << "outputs for preset"
-                                    << preset[QStringLiteral("name")].toString();
-        }
-        return configVar;
-    }
+        return preset.shortcut;
     case IsCurrentRole:
-        return preset[QStringLiteral("isCurrent")];
+        return preset.isCurrent;
     case IsAvailableRole:
-        return preset[QStringLiteral("isAvailable")];
+        return preset.isAvailable;
+    case PreviewGeometryRole:
+        return row.previewGeometry;
     default:
         return QVariant();
     }
@@ -130,124 +131,240 @@ QHash<int, QByteArray> PresetModel::roleNames() const
     roles[LastUsedRole] = "lastUsed";
     roles[OutputCountRole] = "outputCount";
     roles[ShortcutRole] = "shortcut";
-    roles[ConfigurationRole] = "configuration";
     roles[IsCurrentRole] = "isCurrent";
     roles[IsAvailableRole] = "isAvailable";
+    roles[PreviewGeometryRole] = "previewGeometry";
     return roles;
 }
 
 void PresetModel::refreshPresets()
 {
-    if (!m_presetsInterface || !m_presetsInterface->isValid()) {
-        qCWarning(KDISPLAYPRESETS_APPLET) << "PresetModel::refreshPresets() - interface not valid";
+    if (m_syncWatcher) {
+        // Ask again once the reply in flight is in, with whatever revision it brings
+        m_resyncQueued = true;
         return;
     }
 
-    QDBusReply<QVariantList> reply = m_presetsInterface->call(QStringLiteral("getPresets"));
-    if (reply.isValid()) {
-        QVariantList presets;
-        const QVariantList &rawPresets = reply.value();
+    QDBusMessage message = presetsCall(QStringLiteral("getPresetsSince"));
+    message << m_revision;
+
+    m_syncWatcher = new QDBusPendingCallWatcher(QDBusConnection::sessionBus().asyncCall(message), this);
+    connect(m_syncWatcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        m_syncWatcher = nullptr;
+
+        const QDBusPendingReply<PresetsDelta> reply = *watcher;
+        if (reply.isError()) {
+            qCWarning(KDISPLAYPRESETS_APPLET) << "PresetModel::refreshPresets() - D-Bus call failed:" << reply.error().message();
+        } else {
+            applyDelta(reply.value());
+        }
+
+        if (std::exchange(m_resyncQueued, false)) {
+            refreshPresets();
+        }
+    });
+}
 
-        // Process each preset
-        for (const QVariant &rawPreset : rawPresets) {
-            QVariantMap preset;
+void PresetModel::applyDelta(const PresetsDelta &delta)
+{
+    if (!delta.fullResync && delta.revision <= m_revision) {
+        // Signals received while the call was in flight already got us here
+        return;
+    }
 
-            if (rawPreset.canConvert<QDBusArgument>()) {
-                preset = deserializePresetData(rawPreset.value<QDBusArgument>());
-            } else if (rawPreset.canConvert<QVariantMap>()) {
-                preset = rawPreset.toMap();
+    if (delta.fullResync && m_presets.isEmpty()) {
+        // First load, one insertion instead of one per preset
+        if (!delta.added.isEmpty()) {
+            beginInsertRows(QModelIndex(), 0, delta.added.count() - 1);
+            for (const PresetSummary &summary : delta.added) {
+                m_presets.append(makeRow(summary));
             }
+            endInsertRows();
+        }
+        m_revision = delta.revision;
+        return;
+    }
 
-            presets.append(preset);
+    if (delta.fullResync) {
+        QSet<QString> presetIds;
+        for (const PresetSummary &summary : delta.added) {
+            presetIds.insert(summary.presetId);
         }
+        for (int row = m_presets.count() - 1; row >= 0; --row) {
+            if (!presetIds.contains(m_presets.at(row).summary.presetId)) {
+                removePreset(m_presets.at(row).summary.presetId);
+            }
+        }
+    }
 
-        beginResetModel();
-        m_presets = presets;
-        endResetModel();
-    } else {
-        qCWarning(KDISPLAYPRESETS_APPLET) << "PresetModel::refreshPresets() - D-Bus call failed:" << reply.error().message();
+    for (const QString &presetId : delta.removed) {
+        removePreset(presetId);
     }
+    for (const PresetSummary &summary : delta.added) {
+        upsertPreset(summary);
+    }
+    for (const PresetSummary &summary : delta.changed) {
+        upsertPreset(summary);
+    }
+
+    m_revision = delta.revision;
 }
 
-void PresetModel::onPresetAvailabilityChanged()
+bool PresetModel::skipSignal(qulonglong fromRevision, qulonglong revision)
 {
-    qCDebug(KDISPLAYPRESETS_APPLET) << "PresetModel: Received presetsChanged signal, refreshing presets";
-    refreshPresets();
+    if (m_revision == 0 || fromRevision > m_revision) {
+        qCDebug(KDISPLAYPRESETS_APPLET) << "PresetModel: Missed changes between revisions" << m_revision << "and" << fromRevision << ", resyncing";
+        refreshPresets();
+        return true;
+    }
+
+    // Already covered by a newer fetch. Both signals of one flush share their
+    // range and carry absolute state, so the second one at m_revision still applies.
+    return revision < m_revision;
 }
 
-QVariantMap PresetModel::deserializePresetData(const QDBusArgument &arg) const
-{
-    QVariantMap preset;
-    arg >> preset;
-
-    // Deserialize nested configuration if it's QDBusArgument
-    if (preset.contains(QStringLiteral("configuration"))) {
-        QVariant configVar = preset[QStringLiteral("configuration")];
-        if (configVar.canConvert<QDBusArgument>()) {
-            QDBusArgument configArg = configVar.value<QDBusArgument>();
-            QVariantMap configMap;
-            configArg >> configMap;
-
-            // Deserialize outputs array if it's QDBusArgument
-            if (configMap.contains(QStringLiteral("outputs"))) {
-                QVariant outputsVar = configMap[QStringLiteral("outputs")];
-                if (outputsVar.canConvert<QDBusArgument>()) {
-                    QVariantList outputsList = deserializeOutputsList(outputsVar.value<QDBusArgument>());
-                    configMap[QStringLiteral("outputs")] = outputsList;
-                    qCDebug(KDISPLAYPRESETS_APPLET) << "PresetModel: Deserialized" << outputsList.count() << "outputs from QDBusArgument";
-                } else if (outputsVar.canConvert<QVariantList>()) {
-                    configMap[QStringLiteral("outputs")] = outputsVar.toList();
-                    qCDebug(KDISPLAYPRESETS_APPLET) << "PresetModel: Got" << outputsVar.toList().count() << "outputs as QVariantList";
-                }
-            } else {
-                qCDebug(KDISPLAYPRESETS_APPLET) << "PresetModel: Configuration does not contain outputs";
-            }
+void PresetModel::onPresetsChanged(const PresetSummaryList &changedPresets,
+                                   const QStringList &removedPresetIds,
+                                   qulonglong fromRevision,
+                                   qulonglong revision)
+{
+    if (skipSignal(fromRevision, revision)) {
+        return;
+    }
+
+    for (const QString &presetId : removedPresetIds) {
+        removePreset(presetId);
+    }
+    for (const PresetSummary &summary : changedPresets) {
+        upsertPreset(summary);
+    }
+    m_revision = revision;
+}
+
+void PresetModel::onPresetStatusChanged(const PresetStatusList &statuses, qulonglong fromRevision, qulonglong revision)
+{
+    if (skipSignal(fromRevision, revision)) {
+        return;
+    }
 
-            preset[QStringLiteral("configuration")] = configMap;
+    // Status flips after a hotplug only touch two fields, no need to refetch everything
+    for (const PresetStatus &status : statuses) {
+        const int row = rowOf(status.presetId);
+        if (row < 0) {
+            continue;
+        }
+
+        PresetSummary &preset = m_presets[row].summary;
+        QList<int> roles;
+        if (preset.isAvailable != status.isAvailable) {
+            preset.isAvailable = status.isAvailable;
+            roles.append(IsAvailableRole);
+        }
+        if (preset.isCurrent != status.isCurrent) {
+            preset.isCurrent = status.isCurrent;
+            roles.append(IsCurrentRole);
+        }
+        if (!roles.isEmpty()) {
+            Q_EMIT dataChanged(index(row), index(row), roles);
         }
     }
+    m_revision = revision;
+}
+
+void PresetModel::onServiceOwnerChanged(const QString &service, const QString &oldOwner, const QString &newOwner)
+{
+    Q_UNUSED(service)
 
-    return preset;
+    if (!oldOwner.isEmpty()) {
+        // Anything still in flight was answered by the old instance
+        delete std::exchange(m_syncWatcher, nullptr);
+        m_resyncQueued = false;
+        m_revision = 0;
+    }
+
+    // A first registration is usually our own call activating the daemon, its reply is still valid
+    if (!newOwner.isEmpty() && !m_syncWatcher && m_revision == 0) {
+        refreshPresets();
+    }
 }
 
-QVariantList PresetModel::deserializeOutputsList(const QDBusArgument &outputsArg) const
+void PresetModel::upsertPreset(const PresetSummary &summary)
 {
-    QVariantList outputsList;
-    outputsArg >> outputsList;
+    const int row = rowOf(summary.presetId);
+    if (row < 0) {
+        beginInsertRows(QModelIndex(), m_presets.count(), m_presets.count());
+        m_presets.append(makeRow(summary));
+        endInsertRows();
+        return;
+    }
 
-    QVariantList deserializedOutputs;
-    for (const QVariant &outputVar : outputsList) {
-        if (outputVar.canConvert<QDBusArgument>()) {
-            QVariantMap outputMap = deserializeOutputData(outputVar.value<QDBusArgument>());
-            deserializedOutputs.append(outputMap);
-        } else {
-            deserializedOutputs.append(outputVar);
-        }
+    // Only the roles that changed, so delegates do not rebuild on every status blip
+    const PresetSummary &previous = m_presets.at(row).summary;
+    QList<int> roles;
+    if (previous.name != summary.name) {
+        roles.append(NameRole);
+    }
+    if (previous.description != summary.description) {
+        roles.append(DescriptionRole);
+    }
+    if (previous.lastUsed != summary.lastUsed) {
+        roles.append(LastUsedRole);
+    }
+    if (previous.outputCount != summary.outputCount) {
+        roles.append(OutputCountRole);
+    }
+    if (previous.shortcut != summary.shortcut) {
+        roles.append(ShortcutRole);
+    }
+    if (previous.isCurrent != summary.isCurrent) {
+        roles.append(IsCurrentRole);
+    }
+    if (previous.isAvailable != summary.isAvailable) {
+        roles.append(IsAvailableRole);
+    }
+    if (previous.preview != summary.preview) {
+        roles.append(PreviewGeometryRole);
+    }
+    if (roles.isEmpty()) {
+        return;
     }
 
-    return deserializedOutputs;
+    // Usage and metadata updates leave the layout alone, keep its decoded geometry
+    PresetRow &presetRow = m_presets[row];
+    if (roles.contains(PreviewGeometryRole)) {
+        presetRow = makeRow(summary);
+    } else {
+        presetRow.summary = summary;
+    }
+    Q_EMIT dataChanged(index(row), index(row), roles);
 }
 
-QVariantMap PresetModel::deserializeOutputData(const QDBusArgument &outputArg) const
+void PresetModel::removePreset(const QString &presetId)
 {
-    QVariantMap outputMap;
-    outputArg >> outputMap;
+    const int row = rowOf(presetId);
+    if (row < 0) {
+        return;
+    }
 
-    // Deserialize nested fields that might be QDBusArgument
-    QStringList nestedFields = {"pos", "mode", "logicalSize"};
-    for (const QString &field : nestedFields) {
-        if (outputMap.contains(field)) {
-            QVariant fieldVar = outputMap[field];
-            if (fieldVar.canConvert<QDBusArgument>()) {
-                QDBusArgument fieldArg = fieldVar.value<QDBusArgument>();
-                QVariantMap fieldMap;
-                fieldArg >> fieldMap;
-                outputMap[field] = fieldMap;
-            }
+    beginRemoveRows(QModelIndex(), row, row);
+    m_presets.removeAt(row);
+    endRemoveRows();
+}
+
+int PresetModel::rowOf(const QString &presetId) const
+{
+    for (int row = 0; row < m_presets.count(); ++row) {
+        if (m_presets.at(row).summary.presetId == presetId) {
+            return row;
         }
     }
+    return -1;
+}
 
-    return outputMap;
+PresetModel::PresetRow PresetModel::makeRow(const PresetSummary &summary)
+{
+    return PresetRow{summary, previewGeometry(summary.preview)};
 }
 
 #include "kdisplaypresets_applet.moc"
@@ -6,12 +6,13 @@
 
 #pragma once
 
+#include "common/dbustypes.h"
+
 #include <Plasma/Applet>
 
 #include <QAbstractListModel>
 
-class QDBusInterface;
-class QDBusArgument;
+class QDBusPendingCallWatcher;
 
 class PresetModel : public QAbstractListModel
 {
@@ -25,13 +26,13 @@ public:
         LastUsedRole,
         OutputCountRole,
         ShortcutRole,
-        ConfigurationRole,
         IsCurrentRole,
         IsAvailableRole,
+        PreviewGeometryRole,
     };
     Q_ENUM(PresetRoles)
 
-    explicit PresetModel(QDBusInterface *presetsInterface, QObject *parent = nullptr);
+    explicit PresetModel(QObject *parent = nullptr);
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
@@ -40,15 +41,32 @@ public:
     Q_INVOKABLE void refreshPresets();
 
 private Q_SLOTS:
-    void onPresetAvailabilityChanged();
+    void onPresetsChanged(const PresetSummaryList &changedPresets, const QStringList &removedPresetIds, qulonglong fromRevision, qulonglong revision);
+    void onPresetStatusChanged(const PresetStatusList &statuses, qulonglong fromRevision, qulonglong revision);
+    void onServiceOwnerChanged(const QString &service, const QString &oldOwner, const QString &newOwner);
 
 private:
-    QVariantMap deserializePresetData(const QDBusArgument &arg) const;
-    QVariantList deserializeOutputsList(const QDBusArgument &outputsArg) const;
-    QVariantMap deserializeOutputData(const QDBusArgument &outputArg) const;
-
-    QDBusInterface *m_presetsInterface;
-    QVariantList m_presets;
+    // Resyncs when signals were missed, true when the signal has nothing new to apply
+    bool skipSignal(qulonglong fromRevision, qulonglong revision);
+    void applyDelta(const PresetsDelta &delta);
+    void upsertPreset(const PresetSummary &summary);
+    void removePreset(const QString &presetId);
+    int rowOf(const QString &presetId) const;
+    struct PresetRow;
+    static PresetRow makeRow(const PresetSummary &summary);
+
+    // Decoded once per change so data() is a plain field read
+    struct PresetRow {
+        PresetSummary summary;
+        // What the preview geometry role hands to QML
+        QVariantMap previewGeometry;
+    };
+    QList<PresetRow> m_presets;
+    // Daemon revision m_presets is in sync with, 0 before the first fetch
+    qulonglong m_revision = 0;
+    // Sync call in flight, deleted to drop its reply when the daemon restarts
+    QDBusPendingCallWatcher *m_syncWatcher = nullptr;
+    bool m_resyncQueued = false;
 };
 
 class KDisplayPresetsApplet : public Plasma::Applet
@@ -61,13 +79,12 @@ public:
     explicit KDisplayPresetsApplet(QObject *parent, const KPluginMetaData &data, const QVariantList &args);
     ~KDisplayPresetsApplet() override;
 
-    void init() override;
-
     QAbstractItemModel *presetModel() const;
 
     Q_INVOKABLE void loadPreset(const QString &presetId);
+    // False when thumbnails cannot be used and the views draw outputs live
+    Q_INVOKABLE bool installThumbnailProvider(QObject *item);
 
 private:
-    QDBusInterface *m_presetsInterface = nullptr;
     PresetModel *m_presetModel = nullptr;
 };
@@ -23,8 +23,8 @@ PlasmoidItem {
     readonly property bool kcmAllowed: KConfig.KAuthorized.authorizeControlModule("kcm_displaypresets")
 
     // PresetModel::PresetRoles enum values (from kdisplaypresets_applet.h)
-    readonly property int isCurrentRole: Qt.UserRole + 8
-    readonly property int isAvailableRole: Qt.UserRole + 9
+    readonly property int isCurrentRole: Qt.UserRole + 7
+    readonly property int isAvailableRole: Qt.UserRole + 8
 
     // Auto-hide logic: Hide when ≤1 available preset and it's current
     Plasmoid.status: {
@@ -81,6 +81,7 @@ PlasmoidItem {
             loadPresetFunc: Plasmoid.loadPreset
             plasmoidHeight: fullRep.height
             plasmoidRoot: fullRep
+            thumbnails: Plasmoid.installThumbnailProvider(fullRep)
         }
 
         // compact the layout